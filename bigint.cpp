@@ -0,0 +1,287 @@
+#include "bigint.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        constexpr uint64_t LIMB_BASE = uint64_t{ 1 } << 32;
+        //   ,   
+        constexpr uint32_t DECIMAL_CHUNK = 1'000'000'000;
+        constexpr size_t DECIMAL_CHUNK_DIGITS = 9;
+
+    }  // namespace
+
+    BigInteger::BigInteger(int64_t value)
+        : negative_(value < 0) {
+        //     ,     INT64_MIN
+        uint64_t magnitude = negative_ ? uint64_t{ 0 } - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        while (magnitude != 0) {
+            limbs_.push_back(static_cast<uint32_t>(magnitude));
+            magnitude >>= 32;
+        }
+    }
+
+    BigInteger::BigInteger(Limbs limbs, bool negative) noexcept
+        : limbs_(move(limbs)) {
+        Trim(limbs_);
+        negative_ = negative && !limbs_.empty();
+    }
+
+    BigInteger BigInteger::FromString(string_view digits) {
+        const bool negative = !digits.empty() && digits.front() == '-';
+        if (negative) digits.remove_prefix(1);
+        if (digits.empty() || !all_of(digits.begin(), digits.end(), [](char c) {
+                return c >= '0' && c <= '9';
+            })) {
+            throw invalid_argument("Invalid integer: "s + string(digits));
+        }
+
+        //     DECIMAL_CHUNK_DIGITS,     
+        Limbs limbs;
+        size_t chunk_size = digits.size() % DECIMAL_CHUNK_DIGITS;
+        if (chunk_size == 0) chunk_size = DECIMAL_CHUNK_DIGITS;
+        while (!digits.empty()) {
+            uint32_t chunk = 0;
+            uint32_t multiplier = 1;
+            for (const char c : digits.substr(0, chunk_size)) {
+                chunk = chunk * 10 + static_cast<uint32_t>(c - '0');
+                multiplier *= 10;
+            }
+            MulAddSmall(limbs, multiplier, chunk);
+            digits.remove_prefix(chunk_size);
+            chunk_size = DECIMAL_CHUNK_DIGITS;
+        }
+        return BigInteger(move(limbs), negative);
+    }
+
+    bool BigInteger::FitsInt64() const noexcept {
+        if (limbs_.size() > 2) return false;
+        uint64_t magnitude = 0;
+        for (size_t i = limbs_.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | limbs_[i];
+        }
+        const uint64_t limit = uint64_t{ 1 } << 63;
+        return negative_ ? magnitude <= limit : magnitude < limit;
+    }
+
+    int64_t BigInteger::ToInt64() const noexcept {
+        uint64_t magnitude = 0;
+        for (size_t i = limbs_.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | limbs_[i];
+        }
+        return negative_ ? static_cast<int64_t>(uint64_t{ 0 } - magnitude) : static_cast<int64_t>(magnitude);
+    }
+
+    string BigInteger::ToString() const {
+        if (limbs_.empty()) return "0"s;
+
+        vector<uint32_t> chunks;
+        Limbs value = limbs_;
+        while (!value.empty()) {
+            chunks.push_back(DivSmall(value, DECIMAL_CHUNK));
+            Trim(value);
+        }
+
+        string result = negative_ ? "-"s : ""s;
+        result += to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            const string chunk = to_string(chunks[i]);
+            result.append(DECIMAL_CHUNK_DIGITS - chunk.size(), '0');
+            result += chunk;
+        }
+        return result;
+    }
+
+    BigInteger BigInteger::operator-() const {
+        return BigInteger(limbs_, !negative_);
+    }
+
+    BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs) {
+        if (lhs.negative_ == rhs.negative_) {
+            return BigInteger(BigInteger::AddMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_);
+        }
+        if (BigInteger::CompareMagnitude(lhs.limbs_, rhs.limbs_) >= 0) {
+            return BigInteger(BigInteger::SubMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_);
+        }
+        return BigInteger(BigInteger::SubMagnitude(rhs.limbs_, lhs.limbs_), rhs.negative_);
+    }
+
+    BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs) {
+        return lhs + -rhs;
+    }
+
+    BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs) {
+        return BigInteger(BigInteger::MulMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_ != rhs.negative_);
+    }
+
+    BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs) {
+        if (rhs.IsZero()) throw domain_error("Division by zero"s);
+        return BigInteger(BigInteger::DivMagnitude(lhs.limbs_, rhs.limbs_), lhs.negative_ != rhs.negative_);
+    }
+
+    bool operator<(const BigInteger& lhs, const BigInteger& rhs) noexcept {
+        if (lhs.negative_ != rhs.negative_) return lhs.negative_;
+        const int magnitude = BigInteger::CompareMagnitude(lhs.limbs_, rhs.limbs_);
+        return lhs.negative_ ? magnitude > 0 : magnitude < 0;
+    }
+
+    int BigInteger::CompareMagnitude(const Limbs& lhs, const Limbs& rhs) noexcept {
+        if (lhs.size() != rhs.size()) return lhs.size() < rhs.size() ? -1 : 1;
+        for (size_t i = lhs.size(); i-- > 0;) {
+            if (lhs[i] != rhs[i]) return lhs[i] < rhs[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    BigInteger::Limbs BigInteger::AddMagnitude(const Limbs& lhs, const Limbs& rhs) {
+        const Limbs& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+        const Limbs& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+
+        Limbs result(longer.size() + 1);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < longer.size(); ++i) {
+            const uint64_t sum = uint64_t{ longer[i] } + (i < shorter.size() ? shorter[i] : 0) + carry;
+            result[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        result.back() = static_cast<uint32_t>(carry);
+        Trim(result);
+        return result;
+    }
+
+    BigInteger::Limbs BigInteger::SubMagnitude(const Limbs& lhs, const Limbs& rhs) {
+        Limbs result(lhs.size());
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            const uint64_t subtrahend = (i < rhs.size() ? rhs[i] : 0) + borrow;
+            borrow = lhs[i] < subtrahend ? 1 : 0;
+            result[i] = static_cast<uint32_t>(lhs[i] + (borrow << 32) - subtrahend);
+        }
+        Trim(result);
+        return result;
+    }
+
+    BigInteger::Limbs BigInteger::MulMagnitude(const Limbs& lhs, const Limbs& rhs) {
+        if (lhs.empty() || rhs.empty()) return {};
+
+        //  :       64 
+        Limbs result(lhs.size() + rhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            uint64_t carry = 0;
+            const uint64_t digit = lhs[i];
+            for (size_t j = 0; j < rhs.size(); ++j) {
+                const uint64_t product = digit * rhs[j] + result[i + j] + carry;
+                result[i + j] = static_cast<uint32_t>(product);
+                carry = product >> 32;
+            }
+            result[i + rhs.size()] = static_cast<uint32_t>(carry);
+        }
+        Trim(result);
+        return result;
+    }
+
+    BigInteger::Limbs BigInteger::DivMagnitude(const Limbs& lhs, const Limbs& rhs) {
+        if (CompareMagnitude(lhs, rhs) < 0) return {};
+        if (rhs.size() == 1) {
+            Limbs quotient = lhs;
+            DivSmall(quotient, rhs[0]);
+            Trim(quotient);
+            return quotient;
+        }
+
+        //   ( D ).   ,   
+        //    :           2
+        const size_t n = rhs.size();
+        const size_t m = lhs.size() - n;
+        const int shift = countl_zero(rhs.back());
+        auto shifted = [shift](const Limbs& value, size_t i) {
+            const uint32_t high = i < value.size() ? value[i] << shift : 0;
+            const uint32_t low = (shift != 0 && i > 0 && i - 1 < value.size()) ? value[i - 1] >> (32 - shift) : 0;
+            return high | low;
+        };
+
+        Limbs v(n);
+        for (size_t i = 0; i < n; ++i) v[i] = shifted(rhs, i);
+        Limbs u(lhs.size() + 1);
+        for (size_t i = 0; i < u.size(); ++i) u[i] = shifted(lhs, i);
+
+        Limbs quotient(m + 1);
+        for (size_t j = m + 1; j-- > 0;) {
+            const uint64_t numerator = (uint64_t{ u[j + n] } << 32) | u[j + n - 1];
+            uint64_t q = numerator / v[n - 1];
+            uint64_t r = numerator % v[n - 1];
+            while (q >= LIMB_BASE || q * v[n - 2] > ((r << 32) | u[j + n - 2])) {
+                --q;
+                r += v[n - 1];
+                if (r >= LIMB_BASE) break;
+            }
+
+            //  q * v    
+            uint64_t carry = 0;
+            int64_t borrow = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t product = q * v[i] + carry;
+                carry = product >> 32;
+                const int64_t diff = int64_t{ u[i + j] } - borrow - static_cast<int64_t>(product & 0xFFFFFFFF);
+                u[i + j] = static_cast<uint32_t>(diff);
+                borrow = diff < 0 ? 1 : 0;
+            }
+            const int64_t diff = int64_t{ u[j + n] } - borrow - static_cast<int64_t>(carry);
+            u[j + n] = static_cast<uint32_t>(diff);
+
+            //     :  
+            if (diff < 0) {
+                --q;
+                uint64_t sum_carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    const uint64_t sum = uint64_t{ u[i + j] } + v[i] + sum_carry;
+                    u[i + j] = static_cast<uint32_t>(sum);
+                    sum_carry = sum >> 32;
+                }
+                u[j + n] = static_cast<uint32_t>(u[j + n] + sum_carry);
+            }
+            quotient[j] = static_cast<uint32_t>(q);
+        }
+        Trim(quotient);
+        return quotient;
+    }
+
+    uint32_t BigInteger::DivSmall(Limbs& value, uint32_t divisor) noexcept {
+        uint64_t remainder = 0;
+        for (size_t i = value.size(); i-- > 0;) {
+            const uint64_t current = (remainder << 32) | value[i];
+            value[i] = static_cast<uint32_t>(current / divisor);
+            remainder = current % divisor;
+        }
+        return static_cast<uint32_t>(remainder);
+    }
+
+    void BigInteger::MulAddSmall(Limbs& value, uint32_t multiplier, uint32_t addend) {
+        uint64_t carry = addend;
+        for (uint32_t& limb : value) {
+            const uint64_t current = uint64_t{ limb } * multiplier + carry;
+            limb = static_cast<uint32_t>(current);
+            carry = current >> 32;
+        }
+        if (carry != 0) {
+            value.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+
+    void BigInteger::Trim(Limbs& limbs) noexcept {
+        while (!limbs.empty() && limbs.back() == 0) {
+            limbs.pop_back();
+        }
+    }
+
+    ostream& operator<<(ostream& os, const BigInteger& value) {
+        return os << value.ToString();
+    }
+
+}  // namespace runtime
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace runtime {
+
+    //   64-    .
+    //  true,      int64_t.    result  
+    inline bool AddOverflow(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_add_overflow(lhs, rhs, &result);
+#else
+        if ((rhs > 0 && lhs > std::numeric_limits<std::int64_t>::max() - rhs)
+            || (rhs < 0 && lhs < std::numeric_limits<std::int64_t>::min() - rhs)) return true;
+        result = lhs + rhs;
+        return false;
+#endif
+    }
+
+    inline bool SubOverflow(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_sub_overflow(lhs, rhs, &result);
+#else
+        if ((rhs < 0 && lhs > std::numeric_limits<std::int64_t>::max() + rhs)
+            || (rhs > 0 && lhs < std::numeric_limits<std::int64_t>::min() + rhs)) return true;
+        result = lhs - rhs;
+        return false;
+#endif
+    }
+
+    inline bool MulOverflow(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_mul_overflow(lhs, rhs, &result);
+#else
+        if (lhs != 0 && rhs != 0) {
+            if (lhs == -1 || rhs == -1) {
+                if (lhs == std::numeric_limits<std::int64_t>::min() || rhs == std::numeric_limits<std::int64_t>::min()) return true;
+            }
+            else if (lhs > 0 ? (rhs > 0 ? lhs > std::numeric_limits<std::int64_t>::max() / rhs
+                                        : rhs < std::numeric_limits<std::int64_t>::min() / lhs)
+                             : (rhs > 0 ? lhs < std::numeric_limits<std::int64_t>::min() / rhs
+                                        : lhs < std::numeric_limits<std::int64_t>::max() / rhs)) {
+                return true;
+            }
+        }
+        result = lhs * rhs;
+        return false;
+#endif
+    }
+
+    //     .      
+    inline bool DivOverflow(std::int64_t lhs, std::int64_t rhs, std::int64_t& result) noexcept {
+        if (lhs == std::numeric_limits<std::int64_t>::min() && rhs == -1) return true;
+        result = lhs / rhs;
+        return false;
+    }
+
+    /*
+     *    .       32- ,  
+     * .      ,      .
+     * ,     ,   
+     */
+    class BigInteger {
+    public:
+        BigInteger() = default;
+        explicit BigInteger(std::int64_t value);
+
+        //    , ,   .
+        //  std::invalid_argument,  digits    
+        [[nodiscard]] static BigInteger FromString(std::string_view digits);
+
+        [[nodiscard]] bool IsZero() const noexcept {
+            return limbs_.empty();
+        }
+
+        [[nodiscard]] bool IsNegative() const noexcept {
+            return negative_;
+        }
+
+        //  true,     int64_t
+        [[nodiscard]] bool FitsInt64() const noexcept;
+        //    int64_t.  FitsInt64()
+        [[nodiscard]] std::int64_t ToInt64() const noexcept;
+
+        //    
+        [[nodiscard]] std::string ToString() const;
+
+        BigInteger operator-() const;
+
+        friend BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs);
+        friend BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs);
+        friend BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs);
+        //  std::domain_error    
+        friend BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs);
+
+        friend bool operator==(const BigInteger& lhs, const BigInteger& rhs) noexcept {
+            return lhs.negative_ == rhs.negative_ && lhs.limbs_ == rhs.limbs_;
+        }
+
+        friend bool operator<(const BigInteger& lhs, const BigInteger& rhs) noexcept;
+
+    private:
+        using Limbs = std::vector<std::uint32_t>;
+
+        BigInteger(Limbs limbs, bool negative) noexcept;
+
+        //   :  -1, 0  1
+        static int CompareMagnitude(const Limbs& lhs, const Limbs& rhs) noexcept;
+        static Limbs AddMagnitude(const Limbs& lhs, const Limbs& rhs);
+        //   rhs     lhs
+        static Limbs SubMagnitude(const Limbs& lhs, const Limbs& rhs);
+        static Limbs MulMagnitude(const Limbs& lhs, const Limbs& rhs);
+        static Limbs DivMagnitude(const Limbs& lhs, const Limbs& rhs);
+        //   value  divisor     
+        static std::uint32_t DivSmall(Limbs& value, std::uint32_t divisor) noexcept;
+        //   value  value * multiplier + addend
+        static void MulAddSmall(Limbs& value, std::uint32_t multiplier, std::uint32_t addend);
+        static void Trim(Limbs& limbs) noexcept;
+
+        Limbs limbs_;
+        bool negative_ = false;
+    };
+
+    std::ostream& operator<<(std::ostream& os, const BigInteger& value);
+
+}  // namespace runtime
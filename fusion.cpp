@@ -0,0 +1,319 @@
+#include "fusion.h"
+
+#include "bigint.h"
+#include "heap.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <optional>
+
+using namespace std;
+
+namespace ast {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    namespace {
+
+        //  value + delta  holder.       .
+        //  false,  holder -        int64_t
+        bool Increment(ObjectHolder& holder, int64_t delta) {
+            auto* number = holder.TryAs<runtime::Number>();
+            int64_t result;
+            if (!number || runtime::AddOverflow(number->GetValue(), delta, result)) return false;
+            if (holder.IsUnique()) {
+                number->SetValue(result);
+            }
+            else {
+                holder = ObjectHolder::Own(runtime::Number{ result });
+            }
+            return true;
+        }
+
+        bool Compare(CompareWithConstant::Operation operation, int64_t lhs, int64_t rhs) noexcept {
+            switch (operation) {
+            case CompareWithConstant::Operation::LESS:
+                return lhs < rhs;
+            case CompareWithConstant::Operation::GREATER:
+                return lhs > rhs;
+            case CompareWithConstant::Operation::EQUAL:
+                return lhs == rhs;
+            case CompareWithConstant::Operation::NOT_EQUAL:
+                return lhs != rhs;
+            case CompareWithConstant::Operation::LESS_OR_EQUAL:
+                return lhs <= rhs;
+            case CompareWithConstant::Operation::GREATER_OR_EQUAL:
+                return lhs >= rhs;
+            }
+            return false;
+        }
+
+        //  
+
+        template <typename T>
+        T* Match(Statement& node) {
+            return dynamic_cast<T*>(&node);
+        }
+
+        std::optional<int64_t> MatchConstant(const Statement& node) {
+            if (const auto* constant = dynamic_cast<const NumericConst*>(&node)) return constant->GetValue().GetValue();
+            return std::nullopt;
+        }
+
+        //   var + c  var - c,  var -    dotted_ids.
+        //     
+        std::optional<int64_t> MatchIncrement(const Statement& node, const vector<string>& dotted_ids) {
+            const auto* operation = dynamic_cast<const BinaryOperation*>(&node);
+            if (!operation || (!dynamic_cast<const Add*>(operation) && !dynamic_cast<const Sub*>(operation))) {
+                return std::nullopt;
+            }
+            const auto* variable = dynamic_cast<const VariableValue*>(&operation->GetLhs());
+            const auto delta = MatchConstant(operation->GetRhs());
+            if (!variable || variable->GetDottedIds() != dotted_ids || !delta) return std::nullopt;
+            if (dynamic_cast<const Add*>(operation)) return delta;
+            if (*delta == numeric_limits<int64_t>::min()) return std::nullopt;
+            return -*delta;
+        }
+
+        // .    node     .  true,   
+
+        // object.field = object.field + c
+        bool FuseFieldIncrement(unique_ptr<Statement>& node) {
+            auto* assignment = Match<FieldAssignment>(*node);
+            if (!assignment) return false;
+            vector<string> field = assignment->GetObject().GetDottedIds();
+            field.push_back(assignment->GetFieldName());
+            const auto delta = MatchIncrement(assignment->GetValue(), field);
+            if (!delta) return false;
+
+            node.release();
+            node = make_unique<FieldIncrement>(unique_ptr<FieldAssignment>(assignment), *delta);
+            return true;
+        }
+
+        // var = var + c
+        bool FuseVariableIncrement(unique_ptr<Statement>& node) {
+            auto* assignment = Match<Assignment>(*node);
+            if (!assignment) return false;
+            const auto delta = MatchIncrement(assignment->GetValue(), { assignment->GetName() });
+            if (!delta) return false;
+
+            node.release();
+            node = make_unique<VariableIncrement>(unique_ptr<Assignment>(assignment), *delta);
+            return true;
+        }
+
+        // var < c, var == c      
+        bool FuseCompareWithConstant(unique_ptr<Statement>& node) {
+            auto* comparison = Match<Comparison>(*node);
+            if (!comparison || !dynamic_cast<const VariableValue*>(&comparison->GetLhs())) return false;
+            const auto constant = MatchConstant(comparison->GetRhs());
+            const auto operation = MatchComparator(comparison->GetComparator());
+            if (!constant || !operation) return false;
+
+            node.release();
+            node = make_unique<CompareWithConstant>(unique_ptr<Comparison>(comparison), *operation, *constant);
+            return true;
+        }
+
+        // return var, return object.field
+        bool FuseReturnVariable(unique_ptr<Statement>& node) {
+            auto* ret = Match<Return>(*node);
+            const auto* variable = ret ? dynamic_cast<const VariableValue*>(&ret->GetStatement()) : nullptr;
+            if (!variable) return false;
+
+            node.release();
+            node = make_unique<ReturnVariable>(unique_ptr<Return>(ret));
+            return true;
+        }
+
+        // print str(x):  print  x  ,  str(x),    
+        bool FusePrintStr(unique_ptr<Statement>& node) {
+            if (!Match<Print>(*node)) return false;
+            bool fused = false;
+            node->VisitChildren([&fused](unique_ptr<Statement>& arg) {
+                if (auto* str = Match<Stringify>(*arg)) {
+                    arg = str->TakeArgument();
+                    fused = true;
+                }
+            });
+            return fused;
+        }
+
+        struct FusionPattern {
+            //    
+            string_view name;
+            bool (*fuse)(unique_ptr<Statement>& node);
+        };
+
+        //  .    ,  ,   ,
+        //     
+        const FusionPattern PATTERNS[] = {
+            { "field_increment"sv, FuseFieldIncrement },
+            { "variable_increment"sv, FuseVariableIncrement },
+            { "compare_with_constant"sv, FuseCompareWithConstant },
+            { "return_variable"sv, FuseReturnVariable },
+            { "print_str"sv, FusePrintStr },
+        };
+
+        void FuseTree(unique_ptr<Statement>& node, FusionStats& stats) {
+            //    ,      
+            node->VisitChildren([&stats](unique_ptr<Statement>& child) {
+                FuseTree(child, stats);
+            });
+            for (const FusionPattern& pattern : PATTERNS) {
+                if (pattern.fuse(node)) {
+                    stats.Record(pattern.name);
+                }
+            }
+        }
+
+    }  // namespace
+
+    std::optional<CompareWithConstant::Operation> MatchComparator(const Comparison::Comparator& comparator) {
+        using Function = bool (*)(const ObjectHolder&, const ObjectHolder&, Context&);
+        constexpr std::pair<Function, CompareWithConstant::Operation> operations[] = {
+            { runtime::Less, CompareWithConstant::Operation::LESS },
+            { runtime::Greater, CompareWithConstant::Operation::GREATER },
+            { runtime::Equal, CompareWithConstant::Operation::EQUAL },
+            { runtime::NotEqual, CompareWithConstant::Operation::NOT_EQUAL },
+            { runtime::LessOrEqual, CompareWithConstant::Operation::LESS_OR_EQUAL },
+            { runtime::GreaterOrEqual, CompareWithConstant::Operation::GREATER_OR_EQUAL },
+        };
+        const Function* function = comparator.target<Function>();
+        if (!function) return std::nullopt;
+        for (const auto& [candidate, operation] : operations) {
+            if (*function == candidate) return operation;
+        }
+        return std::nullopt;
+    }
+
+    FieldIncrement::FieldIncrement(unique_ptr<FieldAssignment> original, int64_t delta)
+        : object_(original->GetObject())
+        , field_name_(original->GetFieldName())
+        , delta_(delta)
+        , original_(move(original)) {
+    }
+
+    ObjectHolder FieldIncrement::Execute(Closure& closure, Context& context) {
+        //      Mython,    
+        auto object = object_.Evaluate(closure, context);
+        if (auto* instance = object.TryAs<runtime::ClassInstance>()) {
+            auto& fields = instance->Fields();
+            if (auto it = fields.find(field_name_); it != fields.end()) {
+                const runtime::Object* previous = it->second.Get();
+                if (Increment(it->second, delta_)) {
+                    if (it->second.Get() != previous) {
+                        runtime::Heap::WriteBarrier(*instance);
+                    }
+                    return it->second;
+                }
+            }
+        }
+        return original_->Execute(closure, context);
+    }
+
+    void FieldIncrement::VisitChildren(const runtime::ChildVisitor& visitor) {
+        original_->VisitChildren(visitor);
+    }
+
+    VariableIncrement::VariableIncrement(unique_ptr<Assignment> original, int64_t delta)
+        : var_(original->GetName())
+        , delta_(delta)
+        , original_(move(original)) {
+    }
+
+    ObjectHolder VariableIncrement::Execute(Closure& closure, Context& context) {
+        if (auto it = closure.find(var_); it != closure.end() && Increment(it->second, delta_)) {
+            return it->second;
+        }
+        return original_->Execute(closure, context);
+    }
+
+    void VariableIncrement::VisitChildren(const runtime::ChildVisitor& visitor) {
+        original_->VisitChildren(visitor);
+    }
+
+    CompareWithConstant::CompareWithConstant(unique_ptr<Comparison> original, Operation operation, int64_t constant)
+        : variable_(dynamic_cast<const VariableValue&>(original->GetLhs()))
+        , operation_(operation)
+        , constant_(constant)
+        , original_(move(original)) {
+    }
+
+    ObjectHolder CompareWithConstant::Execute(Closure& closure, Context& context) {
+        return original_->Execute(closure, context);
+    }
+
+    bool CompareWithConstant::EvaluateCondition(Closure& closure, Context& context) {
+        const auto value = variable_.Evaluate(closure, context);
+        if (const auto* number = value.TryAs<runtime::Number>()) {
+            return Compare(operation_, number->GetValue(), constant_);
+        }
+        return original_->EvaluateCondition(closure, context);
+    }
+
+    void CompareWithConstant::VisitChildren(const runtime::ChildVisitor& visitor) {
+        original_->VisitChildren(visitor);
+    }
+
+    ReturnVariable::ReturnVariable(unique_ptr<Return> original)
+        : variable_(dynamic_cast<const VariableValue&>(original->GetStatement()))
+        , original_(move(original)) {
+    }
+
+    ObjectHolder ReturnVariable::Execute(Closure& closure, Context& context) {
+        return Return::Deliver(variable_.Execute(closure, context), context);
+    }
+
+    void ReturnVariable::VisitChildren(const runtime::ChildVisitor& visitor) {
+        original_->VisitChildren(visitor);
+    }
+
+    void FusionStats::Record(string_view pattern) {
+        auto it = find_if(counts_.begin(), counts_.end(), [pattern](const auto& count) {
+            return count.first == pattern;
+        });
+        if (it == counts_.end()) {
+            counts_.emplace_back(pattern, 1);
+        }
+        else {
+            ++it->second;
+        }
+    }
+
+    size_t FusionStats::GetCount(string_view pattern) const noexcept {
+        for (const auto& [name, count] : counts_) {
+            if (name == pattern) return count;
+        }
+        return 0;
+    }
+
+    size_t FusionStats::GetTotal() const noexcept {
+        size_t total = 0;
+        for (const auto& count : counts_) {
+            total += count.second;
+        }
+        return total;
+    }
+
+    void FusionStats::Print(ostream& out) const {
+        out << "fusion:"sv;
+        for (const FusionPattern& pattern : PATTERNS) {
+            out << (&pattern == PATTERNS ? " "sv : ", "sv) << pattern.name << ' ' << GetCount(pattern.name);
+        }
+        out << '\n';
+    }
+
+    FusionStats Fuse(unique_ptr<Statement>& root) {
+        FusionStats stats;
+        if (root) {
+            FuseTree(root, stats);
+        }
+        return stats;
+    }
+
+}  // namespace ast
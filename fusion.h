@@ -0,0 +1,137 @@
+#pragma once
+
+#include "statement.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ast {
+
+    /*
+     *   ().         
+     *         .  
+     *     ( , ,  ),  
+     *   ,     .   
+     *  -    
+     */
+
+    // object.field = object.field + delta ( - delta). ,    
+    // ,   
+    class FieldIncrement : public Statement {
+    public:
+        FieldIncrement(std::unique_ptr<FieldAssignment> original, std::int64_t delta);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+    private:
+        VariableValue object_;
+        std::string field_name_;
+        std::int64_t delta_;
+        std::unique_ptr<FieldAssignment> original_;
+    };
+
+    // var = var + delta ( - delta). ,     ,   
+    class VariableIncrement : public Statement {
+    public:
+        VariableIncrement(std::unique_ptr<Assignment> original, std::int64_t delta);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const std::string& GetName() const noexcept {
+            return var_;
+        }
+
+        [[nodiscard]] std::int64_t GetDelta() const noexcept {
+            return delta_;
+        }
+
+    private:
+        std::string var_;
+        std::int64_t delta_;
+        std::unique_ptr<Assignment> original_;
+    };
+
+    //     .   if  while  
+    //  int64_t  -
+    class CompareWithConstant : public Statement {
+    public:
+        enum class Operation { LESS, GREATER, EQUAL, NOT_EQUAL, LESS_OR_EQUAL, GREATER_OR_EQUAL };
+
+        CompareWithConstant(std::unique_ptr<Comparison> original, Operation operation, std::int64_t constant);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const VariableValue& GetVariable() const noexcept {
+            return variable_;
+        }
+
+        [[nodiscard]] Operation GetOperation() const noexcept {
+            return operation_;
+        }
+
+        [[nodiscard]] std::int64_t GetConstant() const noexcept {
+            return constant_;
+        }
+
+    private:
+        VariableValue variable_;
+        Operation operation_;
+        std::int64_t constant_;
+        std::unique_ptr<Comparison> original_;
+    };
+
+    // return var  return object.field:      
+    class ReturnVariable : public Statement {
+    public:
+        explicit ReturnVariable(std::unique_ptr<Return> original);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const VariableValue& GetVariable() const noexcept {
+            return variable_;
+        }
+
+    private:
+        VariableValue variable_;
+        std::unique_ptr<Return> original_;
+    };
+
+    //   ,  comparator -     runtime::Less,
+    // runtime::Equal  ..,    
+    std::optional<CompareWithConstant::Operation> MatchComparator(const Comparison::Comparator& comparator);
+
+    //  ,   ,  
+    class FusionStats {
+    public:
+        void Record(std::string_view pattern);
+
+        [[nodiscard]] size_t GetCount(std::string_view pattern) const noexcept;
+        [[nodiscard]] size_t GetTotal() const noexcept;
+
+        //   out         
+        void Print(std::ostream& out) const;
+
+    private:
+        std::vector<std::pair<std::string_view, size_t>> counts_;
+    };
+
+    /*
+     *   .   root     ,   ,
+     *  .     PATTERNS  fusion.cpp:   ,
+     *   ,        ,  
+     *   .      
+     */
+    FusionStats Fuse(std::unique_ptr<Statement>& root);
+
+}  // namespace ast
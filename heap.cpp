@@ -0,0 +1,481 @@
+#include "heap.h"
+
+#include "runtime.h"
+
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <ostream>
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+        thread_local Heap* current_heap = nullptr;
+    }  // namespace
+
+    struct Heap::FreeSlot {
+        FreeSlot* next;
+    };
+
+    //      .      ,
+    //        top
+    struct Heap::Block {
+        Heap* heap;
+        Block* prev;
+        Block* next;
+        FreeSlot* free;
+        std::uint32_t live;
+        std::uint32_t top;
+        std::uint32_t size_class;
+        //          
+        bool partial;
+
+        //    
+        static constexpr std::uint32_t DATA_OFFSET = 64;
+
+        [[nodiscard]] bool HasRoom(size_t slot_size) const noexcept {
+            return free || top + slot_size <= BLOCK_SIZE;
+        }
+
+        char* Data() noexcept {
+            return reinterpret_cast<char*>(this);
+        }
+
+        static Block* Of(void* memory) noexcept {
+            return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(memory) & ~(BLOCK_SIZE - 1));
+        }
+    };
+
+    GcNode::~GcNode() {
+        if (heap_) {
+            Heap::Unlink(heap_->ListOf(*this), *this);
+        }
+    }
+
+    Heap::Heap(HeapOptions options)
+        : options_(options) {
+    }
+
+    Heap::~Heap() {
+        ReclaimAll();
+        if (options_.tracing) {
+            CollectMajor();
+            ReclaimAll();
+        }
+
+        //      
+        for (List* list : { &young_, &old_, &remembered_ }) {
+            while (list->head) {
+                GcNode* node = list->head;
+                Unlink(*list, *node);
+                node->heap_ = nullptr;
+            }
+        }
+        for (SizeClass& size_class : size_classes_) {
+            if (size_class.current) {
+                ::operator delete(size_class.current, align_val_t{ BLOCK_SIZE });
+            }
+        }
+        for (Block* block : free_blocks_) {
+            ::operator delete(block, align_val_t{ BLOCK_SIZE });
+        }
+    }
+
+    Heap* Heap::Current() noexcept {
+        return current_heap;
+    }
+
+    void* Heap::Allocate(size_t size, size_t alignment) {
+        assert(size <= MAX_OBJECT_SIZE && alignment <= GRANULARITY);
+        if (!pending_.empty() && ++allocations_since_slice_ >= options_.slice_interval) {
+            ReclaimSlice(options_.slice_budget);
+        }
+
+        const size_t index = SizeClassOf(size);
+        const size_t slot_size = (index + 1) * GRANULARITY;
+        SizeClass& size_class = size_classes_[index];
+        SizeClassStats& class_stats = stats_.size_classes[index];
+
+        Block* block = size_class.current;
+        if (!block || !block->HasRoom(slot_size)) {
+            //   ,     .  ,  
+            //     
+            if (size_class.partial) {
+                block = size_class.partial;
+                UnlinkPartial(size_class, *block);
+            }
+            else {
+                block = AcquireBlock(index);
+                ++class_stats.blocks;
+            }
+            size_class.current = block;
+        }
+
+        void* memory = nullptr;
+        if (block->free) {
+            memory = block->free;
+            block->free = block->free->next;
+            ++class_stats.free_list_allocations;
+        }
+        else {
+            memory = block->Data() + block->top;
+            block->top += static_cast<std::uint32_t>(slot_size);
+            ++class_stats.bump_allocations;
+        }
+        ++block->live;
+        ++stats_.allocated_objects;
+        ++stats_.live_objects;
+        return memory;
+    }
+
+    void Heap::Free(void* memory) noexcept {
+        Block* block = Block::Of(memory);
+        Heap* heap = block->heap;
+        SizeClass& size_class = heap->size_classes_[block->size_class];
+        --heap->stats_.live_objects;
+        ++heap->stats_.size_classes[block->size_class].frees;
+
+        auto* slot = static_cast<FreeSlot*>(memory);
+        slot->next = block->free;
+        block->free = slot;
+        --block->live;
+
+        if (block == size_class.current) {
+            if (block->live == 0) {
+                block->free = nullptr;
+                block->top = Block::DATA_OFFSET;
+            }
+            return;
+        }
+        if (block->live == 0) {
+            if (block->partial) {
+                heap->UnlinkPartial(size_class, *block);
+            }
+            --heap->stats_.size_classes[block->size_class].blocks;
+            heap->ReleaseBlock(block);
+        }
+        else if (!block->partial) {
+            heap->LinkPartial(size_class, *block);
+        }
+    }
+
+    void Heap::Destroy(Object* object) noexcept {
+        if (!object->in_heap_) {
+            delete object;
+            return;
+        }
+        Heap* heap = Block::Of(object)->heap;
+        if (heap->options_.incremental) {
+            heap->Defer(object);
+            return;
+        }
+        object->~Object();
+        Free(object);
+    }
+
+    void Heap::Defer(Object* object) {
+        //         
+        if (object->gc_node_) {
+            GcNode& node = *static_cast<ClassInstance*>(object);
+            if (node.heap_) {
+                Unlink(ListOf(node), node);
+                node.heap_ = nullptr;
+            }
+        }
+        pending_.push_back(object);
+    }
+
+    void Heap::ReclaimSlice(std::chrono::microseconds budget) {
+        using Clock = std::chrono::steady_clock;
+        //      
+        constexpr size_t clock_check_interval = 32;
+
+        allocations_since_slice_ = 0;
+        const auto start = Clock::now();
+        const auto deadline = start + budget;
+        size_t reclaimed = 0;
+        while (!pending_.empty()) {
+            Object* object = pending_.back();
+            pending_.pop_back();
+            object->~Object();
+            Free(object);
+            if (++reclaimed % clock_check_interval == 0 && Clock::now() >= deadline) {
+                break;
+            }
+        }
+        ++stats_.reclaim_slices;
+        stats_.longest_slice = max(stats_.longest_slice,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start));
+    }
+
+    void Heap::ReclaimAll() {
+        while (!pending_.empty()) {
+            Object* object = pending_.back();
+            pending_.pop_back();
+            object->~Object();
+            Free(object);
+        }
+    }
+
+    Heap::Block* Heap::AcquireBlock(size_t size_class) {
+        static_assert(sizeof(Block) <= Block::DATA_OFFSET && Block::DATA_OFFSET % GRANULARITY == 0);
+        Block* block = nullptr;
+        if (!free_blocks_.empty()) {
+            block = free_blocks_.back();
+            free_blocks_.pop_back();
+        }
+        else {
+            block = static_cast<Block*>(::operator new(BLOCK_SIZE, align_val_t{ BLOCK_SIZE }));
+            ++stats_.live_blocks;
+        }
+        block->heap = this;
+        block->prev = block->next = nullptr;
+        block->free = nullptr;
+        block->live = 0;
+        block->top = Block::DATA_OFFSET;
+        block->size_class = static_cast<std::uint32_t>(size_class);
+        block->partial = false;
+        return block;
+    }
+
+    void Heap::LinkPartial(SizeClass& size_class, Block& block) noexcept {
+        block.prev = nullptr;
+        block.next = size_class.partial;
+        if (size_class.partial) {
+            size_class.partial->prev = &block;
+        }
+        size_class.partial = &block;
+        block.partial = true;
+    }
+
+    void Heap::UnlinkPartial(SizeClass& size_class, Block& block) noexcept {
+        if (block.prev) {
+            block.prev->next = block.next;
+        }
+        else {
+            size_class.partial = block.next;
+        }
+        if (block.next) {
+            block.next->prev = block.prev;
+        }
+        block.prev = block.next = nullptr;
+        block.partial = false;
+    }
+
+    void Heap::ReleaseBlock(Block* block) noexcept {
+        //           
+        constexpr size_t max_free_blocks = 4;
+        if (free_blocks_.size() < max_free_blocks) {
+            free_blocks_.push_back(block);
+            return;
+        }
+        --stats_.live_blocks;
+        ::operator delete(block, align_val_t{ BLOCK_SIZE });
+    }
+
+    void Heap::Link(List& list, GcNode& node) noexcept {
+        node.prev_ = nullptr;
+        node.next_ = list.head;
+        if (list.head) {
+            list.head->prev_ = &node;
+        }
+        list.head = &node;
+        ++list.size;
+    }
+
+    void Heap::Unlink(List& list, GcNode& node) noexcept {
+        if (node.prev_) {
+            node.prev_->next_ = node.next_;
+        }
+        else {
+            list.head = node.next_;
+        }
+        if (node.next_) {
+            node.next_->prev_ = node.prev_;
+        }
+        node.prev_ = node.next_ = nullptr;
+        --list.size;
+    }
+
+    Heap::List& Heap::ListOf(GcNode& node) noexcept {
+        if (node.remembered_) return remembered_;
+        return node.old_ ? old_ : young_;
+    }
+
+    void Heap::Track(GcNode& node) {
+        if (!options_.tracing) {
+            return;
+        }
+        node.heap_ = this;
+        Link(young_, node);
+        if (++tracked_since_collection_ >= options_.minor_threshold && !collecting_) {
+            if (++collections_since_major_ >= options_.major_interval) {
+                CollectMajor();
+            }
+            else {
+                CollectMinor();
+            }
+        }
+    }
+
+    void Heap::Remember(GcNode& node) {
+        Unlink(old_, node);
+        node.remembered_ = true;
+        Link(remembered_, node);
+    }
+
+    void Heap::CollectMinor() {
+        Collect(false);
+    }
+
+    void Heap::CollectMajor() {
+        collections_since_major_ = 0;
+        Collect(true);
+    }
+
+    void Heap::Collect(bool major) {
+        if (collecting_) {
+            return;
+        }
+        collecting_ = true;
+        tracked_since_collection_ = 0;
+
+        auto as_instance = [](GcNode* node) {
+            return static_cast<ClassInstance*>(node);
+        };
+        //  -,    holder,  nullptr
+        auto candidate_of = [](const ObjectHolder& holder) -> GcNode* {
+            auto* instance = holder.TryAs<ClassInstance>();
+            if (!instance) return nullptr;
+            GcNode* node = instance;
+            return node->candidate_ ? node : nullptr;
+        };
+
+        vector<GcNode*> candidates;
+        candidates.reserve(young_.size + remembered_.size + (major ? old_.size : 0));
+        for (List* list : { &young_, &remembered_, &old_ }) {
+            if (list == &old_ && !major) continue;
+            for (GcNode* node = list->head; node; node = node->next_) {
+                candidates.push_back(node);
+            }
+        }
+
+        //  :      
+        for (GcNode* node : candidates) {
+            node->candidate_ = true;
+            node->reachable_ = false;
+            node->gc_refs_ = as_instance(node)->GetRefCount();
+        }
+        for (GcNode* node : candidates) {
+            for (const auto& [name, field] : as_instance(node)->Fields()) {
+                if (GcNode* target = candidate_of(field)) {
+                    --target->gc_refs_;
+                }
+            }
+        }
+
+        //      .   -  , 
+        //     - ,     
+        vector<GcNode*> stack;
+        for (GcNode* node : candidates) {
+            if (node->gc_refs_ > 0 && !node->reachable_) {
+                node->reachable_ = true;
+                stack.push_back(node);
+            }
+        }
+        while (!stack.empty()) {
+            GcNode* node = stack.back();
+            stack.pop_back();
+            for (const auto& [name, field] : as_instance(node)->Fields()) {
+                GcNode* target = candidate_of(field);
+                if (target && !target->reachable_) {
+                    target->reachable_ = true;
+                    stack.push_back(target);
+                }
+            }
+        }
+
+        //      ,      ,
+        //          
+        vector<ObjectHolder> garbage;
+        for (GcNode* node : candidates) {
+            node->candidate_ = false;
+            if (!node->reachable_) {
+                garbage.push_back(ObjectHolder::Share(*as_instance(node)));
+            }
+        }
+        for (ObjectHolder& holder : garbage) {
+            holder.TryAs<ClassInstance>()->Fields().clear();
+        }
+        stats_.collected_objects += garbage.size();
+        garbage.clear();
+
+        //   ,     
+        while (remembered_.head) {
+            GcNode* node = remembered_.head;
+            Unlink(remembered_, *node);
+            node->remembered_ = false;
+            Link(old_, *node);
+        }
+        for (GcNode* node = young_.head; node;) {
+            GcNode* next = node->next_;
+            if (++node->age_ >= options_.promotion_age) {
+                Unlink(young_, *node);
+                node->old_ = true;
+                Link(old_, *node);
+                ++stats_.promoted_objects;
+            }
+            node = next;
+        }
+
+        ++(major ? stats_.major_collections : stats_.minor_collections);
+        collecting_ = false;
+    }
+
+    HeapStats Heap::GetStats() const {
+        HeapStats stats = stats_;
+        stats.young_objects = young_.size;
+        stats.old_objects = old_.size + remembered_.size;
+        stats.pending_objects = pending_.size();
+        return stats;
+    }
+
+    void Heap::PrintStats(std::ostream& out) const {
+        const HeapStats stats = GetStats();
+        out << "heap: allocated "sv << stats.allocated_objects << ", live "sv << stats.live_objects
+            << ", blocks "sv << stats.live_blocks << '\n';
+        for (size_t i = 0; i < SIZE_CLASS_COUNT; ++i) {
+            const SizeClassStats& size_class = stats.size_classes[i];
+            if (size_class.bump_allocations + size_class.free_list_allocations == 0) continue;
+            out << "  size "sv << (i + 1) * GRANULARITY << ": bump "sv << size_class.bump_allocations
+                << ", free list "sv << size_class.free_list_allocations << ", frees "sv << size_class.frees
+                << ", blocks "sv << size_class.blocks << '\n';
+        }
+        if (options_.tracing) {
+            out << "gc: minor "sv << stats.minor_collections << ", major "sv << stats.major_collections
+                << ", collected "sv << stats.collected_objects << ", promoted "sv << stats.promoted_objects
+                << ", young "sv << stats.young_objects << ", old "sv << stats.old_objects << '\n';
+        }
+        if (options_.incremental) {
+            out << "reclaim: slices "sv << stats.reclaim_slices << ", pending "sv << stats.pending_objects
+                << ", longest slice "sv << stats.longest_slice.count() << " ns"sv << '\n';
+        }
+    }
+
+    HeapScope::HeapScope(Heap& heap) noexcept
+        : previous_(current_heap) {
+        current_heap = &heap;
+    }
+
+    HeapScope::HeapScope(std::nullptr_t) noexcept
+        : previous_(current_heap) {
+        current_heap = nullptr;
+    }
+
+    HeapScope::~HeapScope() {
+        current_heap = previous_;
+    }
+
+}  // namespace runtime
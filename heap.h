@@ -0,0 +1,243 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace runtime {
+
+    class Object;
+    class Heap;
+
+    //   ,     .
+    //        :  ,  
+    //    ( ,    )
+    class GcNode {
+    public:
+        GcNode() = default;
+        //       ,     
+        GcNode(const GcNode& /*other*/) noexcept {
+        }
+        GcNode& operator=(const GcNode& /*other*/) noexcept {
+            return *this;
+        }
+
+        ~GcNode();
+
+        //  true,     
+        [[nodiscard]] bool IsOld() const noexcept {
+            return old_;
+        }
+
+    private:
+        friend class Heap;
+
+        Heap* heap_ = nullptr;
+        GcNode* prev_ = nullptr;
+        GcNode* next_ = nullptr;
+        //  ,       
+        std::int64_t gc_refs_ = 0;
+        std::uint8_t age_ = 0;
+        bool old_ = false;
+        bool remembered_ = false;
+        bool candidate_ = false;
+        bool reachable_ = false;
+    };
+
+    //   
+    struct HeapOptions {
+        //        
+        bool tracing = false;
+        //       
+        size_t minor_threshold = 4096;
+        //  major_interval-    
+        size_t major_interval = 8;
+        //    ,       
+        std::uint8_t promotion_age = 2;
+
+        //         
+        bool incremental = false;
+        //      
+        std::chrono::microseconds slice_budget{ 100 };
+        //      
+        size_t slice_interval = 64;
+    };
+
+    //       
+    struct SizeClassStats {
+        size_t bump_allocations = 0;
+        size_t free_list_allocations = 0;
+        size_t frees = 0;
+        size_t blocks = 0;
+    };
+
+    //   
+    struct HeapStats {
+        size_t allocated_objects = 0;
+        size_t live_objects = 0;
+        size_t live_blocks = 0;
+        size_t young_objects = 0;
+        size_t old_objects = 0;
+        size_t minor_collections = 0;
+        size_t major_collections = 0;
+        size_t collected_objects = 0;
+        size_t promoted_objects = 0;
+        size_t pending_objects = 0;
+        size_t reclaim_slices = 0;
+        std::chrono::nanoseconds longest_slice{ 0 };
+        //    : i-      (i + 1) * 16 
+        std::array<SizeClassStats, 16> size_classes{};
+    };
+
+    /*
+     *  . ,   ObjectHolder::Own,   
+     *  (. HeapScope),      : Number, Bool, String 
+     * ClassInstance     .     ,    -
+     *              
+     * .    ,       .
+     *   ,   -  ,      
+     * .
+     *
+     *    -   .    
+     *    ,     .   
+     *  ,   :         
+     *  .   .    ,   
+     *   ,    Closure ,    C++ 
+     *  .       : , 
+     *    ,    .
+     *
+     *   incremental      ,    . 
+     *      ,  ,    
+     *  ,     .      
+     *    ,   .
+     *
+     *             
+     */
+    class Heap {
+    public:
+        //    .     ,   
+        //    
+        static constexpr size_t BLOCK_SIZE = 32 * 1024;
+        //   
+        static constexpr size_t GRANULARITY = 16;
+        static constexpr size_t SIZE_CLASS_COUNT = std::tuple_size_v<decltype(HeapStats::size_classes)>;
+        //      
+        static constexpr size_t MAX_OBJECT_SIZE = GRANULARITY * SIZE_CLASS_COUNT;
+
+        explicit Heap(HeapOptions options = {});
+        ~Heap();
+
+        Heap(const Heap&) = delete;
+        Heap& operator=(const Heap&) = delete;
+
+        //        size
+        static constexpr size_t SizeClassOf(size_t size) noexcept {
+            return size == 0 ? 0 : (size - 1) / GRANULARITY;
+        }
+
+        //  ,     ,  nullptr
+        [[nodiscard]] static Heap* Current() noexcept;
+
+        //      size
+        [[nodiscard]] void* Allocate(size_t size, size_t alignment);
+        //   ,   Allocate
+        static void Free(void* memory) noexcept;
+
+        //  ,     ,    
+        static void Destroy(Object* object) noexcept;
+
+        //   ,     budget
+        void ReclaimSlice(std::chrono::microseconds budget);
+        //    
+        void ReclaimAll();
+
+        //       .   
+        void Track(GcNode& node);
+
+        //  :      node
+        static void WriteBarrier(GcNode& node) {
+            if (node.old_ && !node.remembered_ && node.heap_) {
+                node.heap_->Remember(node);
+            }
+        }
+
+        //           .
+        //       
+        void CollectMinor();
+        //        
+        void CollectMajor();
+
+        [[nodiscard]] const HeapOptions& GetOptions() const noexcept {
+            return options_;
+        }
+
+        [[nodiscard]] HeapStats GetStats() const;
+        //      
+        void PrintStats(std::ostream& out) const;
+
+    private:
+        friend class GcNode;
+        struct Block;
+        struct FreeSlot;
+
+        struct SizeClass {
+            // ,    
+            Block* current = nullptr;
+            //   ,  
+            Block* partial = nullptr;
+        };
+
+
+        struct List {
+            GcNode* head = nullptr;
+            size_t size = 0;
+        };
+
+        void Remember(GcNode& node);
+        void Defer(Object* object);
+        void Collect(bool major);
+        Block* AcquireBlock(size_t size_class);
+        void ReleaseBlock(Block* block) noexcept;
+        void LinkPartial(SizeClass& size_class, Block& block) noexcept;
+        void UnlinkPartial(SizeClass& size_class, Block& block) noexcept;
+
+        static void Link(List& list, GcNode& node) noexcept;
+        static void Unlink(List& list, GcNode& node) noexcept;
+        List& ListOf(GcNode& node) noexcept;
+
+        HeapOptions options_;
+        HeapStats stats_;
+
+        std::array<SizeClass, SIZE_CLASS_COUNT> size_classes_;
+        std::vector<Block*> free_blocks_;
+
+        List young_;
+        List old_;
+        List remembered_;
+        size_t tracked_since_collection_ = 0;
+        size_t collections_since_major_ = 0;
+        bool collecting_ = false;
+
+        std::vector<Object*> pending_;
+        size_t allocations_since_slice_ = 0;
+    };
+
+    //          
+    class HeapScope {
+    public:
+        explicit HeapScope(Heap& heap) noexcept;
+        //   : ,    ,   
+        explicit HeapScope(std::nullptr_t) noexcept;
+        ~HeapScope();
+
+        HeapScope(const HeapScope&) = delete;
+        HeapScope& operator=(const HeapScope&) = delete;
+
+    private:
+        Heap* previous_;
+    };
+
+}  // namespace runtime
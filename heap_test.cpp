@@ -0,0 +1,159 @@
+#include "heap.h"
+#include "runtime.h"
+#include "statement.h"
+#include "test_runner_p.h"
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        HeapOptions ManualCollection() {
+            HeapOptions options;
+            options.tracing = true;
+            options.minor_threshold = 1'000'000;
+            return options;
+        }
+
+        ClassInstance& AsInstance(const ObjectHolder& holder) {
+            return *holder.TryAs<ClassInstance>();
+        }
+
+        void TestHeapAllocation() {
+            Heap heap(ManualCollection());
+            HeapScope scope(heap);
+            {
+                auto number = ObjectHolder::Own(Number{ 42 });
+                auto str = ObjectHolder::Own(String{ "hello"s });
+                ASSERT_EQUAL(heap.GetStats().live_objects, 2U);
+                ASSERT_EQUAL(number.TryAs<Number>()->GetValue(), 42);
+                ASSERT_EQUAL(str.TryAs<String>()->GetValue(), "hello"s);
+            }
+            ASSERT_EQUAL(heap.GetStats().live_objects, 0U);
+
+            const size_t blocks = heap.GetStats().live_blocks;
+            for (int i = 0; i < 10000; ++i) {
+                auto number = ObjectHolder::Own(Number{ i });
+            }
+            //    
+            ASSERT_EQUAL(heap.GetStats().live_blocks, blocks);
+        }
+
+        void TestSizeClassPools() {
+            Heap heap(ManualCollection());
+            HeapScope scope(heap);
+
+            std::vector<ObjectHolder> numbers;
+            for (int i = 0; i < 1000; ++i) {
+                numbers.push_back(ObjectHolder::Own(Number{ i }));
+                numbers.push_back(ObjectHolder::Own(Bool{ i % 2 == 0 }));
+            }
+            const Object* freed = numbers.back().Get();
+            numbers.back() = ObjectHolder::None();
+
+            //         
+            auto reused = ObjectHolder::Own(Number{ -1 });
+            ASSERT_EQUAL(reused.Get(), freed);
+
+            const auto stats = heap.GetStats();
+            const auto& number_stats = stats.size_classes[Heap::SizeClassOf(sizeof(Number))];
+            ASSERT_EQUAL(number_stats.free_list_allocations, 1U);
+            ASSERT_EQUAL(number_stats.frees, 1U);
+            ASSERT_EQUAL(stats.live_objects, 2000U);
+        }
+
+        void TestCollectCycles() {
+            Class cls{ "Node"s, {}, nullptr };
+            Heap heap(ManualCollection());
+            HeapScope scope(heap);
+
+            Closure frame;
+            {
+                auto a = ObjectHolder::Own(ClassInstance{ cls });
+                auto b = ObjectHolder::Own(ClassInstance{ cls });
+                AsInstance(a).Fields()["next"s] = b;
+                AsInstance(b).Fields()["next"s] = a;
+                AsInstance(a).Fields()["self"s] = a;
+
+                auto kept = ObjectHolder::Own(ClassInstance{ cls });
+                AsInstance(kept).Fields()["self"s] = kept;
+                AsInstance(kept).Fields()["value"s] = ObjectHolder::Own(Number{ 7 });
+                frame["kept"s] = kept;
+            }
+            ASSERT_EQUAL(heap.GetStats().live_objects, 4U);
+
+            heap.CollectMinor();
+            const auto stats = heap.GetStats();
+            ASSERT_EQUAL(stats.collected_objects, 2U);
+            ASSERT_EQUAL(stats.live_objects, 2U);
+            ASSERT_EQUAL(AsInstance(frame.at("kept"s)).Fields().count("value"s), 1U);
+        }
+
+        void TestWriteBarrier() {
+            Class cls{ "Node"s, {}, nullptr };
+            Heap heap(ManualCollection());
+            HeapScope scope(heap);
+            DummyContext context;
+
+            Closure closure{ {"parent"s, ObjectHolder::Own(ClassInstance{cls})} };
+            for (int i = 0; i < heap.GetOptions().promotion_age; ++i) {
+                heap.CollectMinor();
+            }
+            ASSERT(AsInstance(closure.at("parent"s)).IsOld());
+
+            closure["child"s] = ObjectHolder::Own(ClassInstance{ cls });
+            ast::FieldAssignment(ast::VariableValue{ "parent"s }, "child"s,
+                make_unique<ast::VariableValue>("child"s)).Execute(closure, context);
+            ast::FieldAssignment(ast::VariableValue{ "child"s }, "parent"s,
+                make_unique<ast::VariableValue>("parent"s)).Execute(closure, context);
+            closure.clear();
+
+            //     ,     
+            heap.CollectMinor();
+            ASSERT_EQUAL(heap.GetStats().collected_objects, 2U);
+            ASSERT_EQUAL(heap.GetStats().live_objects, 0U);
+        }
+
+        void TestIncrementalReclamation() {
+            Class cls{ "Node"s, {}, nullptr };
+            HeapOptions options = ManualCollection();
+            options.incremental = true;
+            options.slice_budget = std::chrono::microseconds{ 0 };
+            Heap heap(options);
+            HeapScope scope(heap);
+
+            //       
+            constexpr int chain_length = 500'000;
+            {
+                auto head = ObjectHolder::Own(ClassInstance{ cls });
+                for (int i = 0; i < chain_length; ++i) {
+                    auto node = ObjectHolder::Own(ClassInstance{ cls });
+                    AsInstance(node).Fields()["next"s] = std::move(head);
+                    head = std::move(node);
+                }
+            }
+            ASSERT_EQUAL(heap.GetStats().pending_objects, 1U);
+            ASSERT_EQUAL(heap.GetStats().live_objects, chain_length + 1U);
+
+            heap.ReclaimSlice(std::chrono::microseconds{ 0 });
+            const auto stats = heap.GetStats();
+            ASSERT(stats.live_objects > 0U);
+            ASSERT_EQUAL(stats.pending_objects, 1U);
+
+            heap.ReclaimAll();
+            ASSERT_EQUAL(heap.GetStats().live_objects, 0U);
+            ASSERT_EQUAL(heap.GetStats().pending_objects, 0U);
+        }
+
+    }  // namespace
+
+    void RunHeapTests(TestRunner& tr) {
+        RUN_TEST(tr, runtime::TestHeapAllocation);
+        RUN_TEST(tr, runtime::TestSizeClassPools);
+        RUN_TEST(tr, runtime::TestCollectCycles);
+        RUN_TEST(tr, runtime::TestWriteBarrier);
+        RUN_TEST(tr, runtime::TestIncrementalReclamation);
+    }
+
+}  // namespace runtime
@@ -0,0 +1,192 @@
+#include "inliner.h"
+
+#include "heap.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+/*
+ *    :     return self.field[.field...]
+ *      self.field = param.   ,   
+ *     ,      .  
+ * Mython    ,       
+ *     return   .    
+ *         
+ */
+
+namespace ast {
+
+    using runtime::Closure;
+    using runtime::Context;
+    using runtime::ObjectHolder;
+
+    namespace {
+
+        //   ,        
+        constexpr size_t MAX_INLINED_CLASSES = 4;
+
+        //       nullptr
+        const Statement* SingleStatement(const runtime::Method& method) {
+            const auto* body = dynamic_cast<const MethodBody*>(method.body.get());
+            const auto* compound = body ? dynamic_cast<const Compound*>(&body->GetBody()) : nullptr;
+            if (!compound || compound->GetStatements().size() != 1) return nullptr;
+            return compound->GetStatements().front().get();
+        }
+
+        //   self.field1.field2...    
+        optional<vector<string>> MatchSelfField(const Statement& statement) {
+            const auto* variable = dynamic_cast<const VariableValue*>(&statement);
+            if (!variable) return nullopt;
+            const auto& ids = variable->GetDottedIds();
+            if (ids.size() < 2 || ids.front() != runtime::SELF_NAME) return nullopt;
+            return vector<string>(ids.begin() + 1, ids.end());
+        }
+
+        //   ,   -     
+        optional<InlinedMethod> MatchAccessor(const runtime::Class& cls, const runtime::Method& method) {
+            const Statement* statement = SingleStatement(method);
+            if (!statement) return nullopt;
+
+            // def get(): return self.value
+            if (const auto* ret = dynamic_cast<const Return*>(statement)) {
+                auto path = MatchSelfField(ret->GetStatement());
+                if (!path || !method.formal_params.empty()) return nullopt;
+                return InlinedMethod{ &cls, std::move(*path), nullopt };
+            }
+
+            // def set(value): self.value = value
+            if (const auto* assignment = dynamic_cast<const FieldAssignment*>(statement)) {
+                const auto& object = assignment->GetObject().GetDottedIds();
+                const auto* value = dynamic_cast<const VariableValue*>(&assignment->GetValue());
+                if (object.size() != 1 || object.front() != runtime::SELF_NAME || !value
+                    || value->GetDottedIds().size() != 1) {
+                    return nullopt;
+                }
+                const auto& params = method.formal_params;
+                const auto param = find(params.begin(), params.end(), value->GetDottedIds().front());
+                if (param == params.end() || *param == runtime::SELF_NAME) return nullopt;
+                return InlinedMethod{ &cls, { assignment->GetFieldName() }, static_cast<size_t>(param - params.begin()) };
+            }
+            return nullopt;
+        }
+
+        void CollectClasses(Statement& node, vector<const runtime::Class*>& classes) {
+            if (const auto* definition = dynamic_cast<const ClassDefinition*>(&node)) {
+                classes.push_back(&definition->GetClass());
+            }
+            node.VisitChildren([&classes](unique_ptr<Statement>& child) {
+                CollectClasses(*child, classes);
+            });
+        }
+
+        void InlineCalls(unique_ptr<Statement>& node, const vector<const runtime::Class*>& classes, int64_t min_calls,
+                         InlineStats& stats) {
+            node->VisitChildren([&classes, min_calls, &stats](unique_ptr<Statement>& child) {
+                InlineCalls(child, classes, min_calls, stats);
+            });
+
+            auto* call = dynamic_cast<MethodCall*>(node.get());
+            if (!call || call->GetCalls() < min_calls) return;
+            vector<InlinedMethod> methods;
+            for (const runtime::Class* cls : classes) {
+                const runtime::Method* method = cls->GetMethod(call->GetMethodName());
+                if (!method || method->formal_params.size() != call->GetArgumentCount()) continue;
+                if (auto inlined = MatchAccessor(*cls, *method)) {
+                    methods.push_back(std::move(*inlined));
+                }
+            }
+            if (methods.empty() || methods.size() > MAX_INLINED_CLASSES) return;
+
+            ++(methods.front().param ? stats.setters : stats.getters);
+            node.release();
+            node = make_unique<InlinedCall>(unique_ptr<MethodCall>(call), std::move(methods));
+        }
+
+    }  // namespace
+
+    InlinedCall::InlinedCall(unique_ptr<MethodCall> call, vector<InlinedMethod> methods)
+        : call_(move(call))
+        , methods_(move(methods))
+        , borrow_object_(all_of(call_->args_.begin(), call_->args_.end(), [](const auto& arg) {
+            return arg->IsPure();
+        })) {
+    }
+
+    ObjectHolder InlinedCall::Execute(Closure& closure, Context& context) {
+        //   -    
+        call_->Count();
+        auto object = borrow_object_ ? call_->object_->Evaluate(closure, context) : call_->object_->Execute(closure, context);
+        if (auto* instance = object.TryAs<runtime::ClassInstance>()) {
+            for (const InlinedMethod& method : methods_) {
+                if (method.cls != &instance->GetClass()) continue;
+                if (auto result = Run(method, *instance, closure, context)) {
+                    return std::move(*result);
+                }
+                break;
+            }
+        }
+        //    :    
+        object.Pin();
+        return call_->Invoke(std::move(object), closure, context);
+    }
+
+    optional<ObjectHolder> InlinedCall::Run(const InlinedMethod& method, runtime::ClassInstance& instance,
+                                            Closure& closure, Context& context) {
+        runtime::StepBudget::Step();
+        if (method.param) {
+            runtime::Arguments args(call_->args_.size());
+            for (size_t i = 0; i < call_->args_.size(); ++i) {
+                args[i] = call_->args_[i]->Execute(closure, context);
+            }
+            instance.Fields().insert_or_assign(method.field_path.front(), std::move(args[*method.param]));
+            runtime::Heap::WriteBarrier(instance);
+            return ObjectHolder::None();
+        }
+
+        //   ,      ,   
+        runtime::ClassInstance* current = &instance;
+        const ObjectHolder* value = nullptr;
+        for (const string& field : method.field_path) {
+            if (!current) return nullopt;
+            const auto it = current->Fields().find(field);
+            if (it == current->Fields().end()) return nullopt;
+            value = &it->second;
+            current = value->TryAs<runtime::ClassInstance>();
+        }
+        return *value;
+    }
+
+    void InlinedCall::VisitChildren(const runtime::ChildVisitor& visitor) {
+        call_->VisitChildren(visitor);
+        borrow_object_ = all_of(call_->args_.begin(), call_->args_.end(), [](const auto& arg) {
+            return arg->IsPure();
+        });
+    }
+
+    void InlineStats::Print(ostream& out) const {
+        out << "inline: getters "sv << getters << ", setters "sv << setters << '\n';
+    }
+
+    InlineStats InlineMethods(unique_ptr<Statement>& root) {
+        InlineStats stats;
+        if (!root) return stats;
+
+        vector<const runtime::Class*> classes;
+        CollectClasses(*root, classes);
+        if (!classes.empty()) {
+            InlineCalls(root, classes, 0, stats);
+        }
+        return stats;
+    }
+
+    InlineStats InlineCalls(unique_ptr<Statement>& node, const vector<const runtime::Class*>& classes, int64_t min_calls) {
+        InlineStats stats;
+        if (node && !classes.empty()) {
+            InlineCalls(node, classes, min_calls, stats);
+        }
+        return stats;
+    }
+
+}  // namespace ast
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "statement.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ast {
+
+    //   ,    
+    struct InlinedMethod {
+        // ,     
+        const runtime::Class* cls = nullptr;
+        //    self:    ,    
+        std::vector<std::string> field_path;
+        //  ,   .    
+        std::optional<size_t> param;
+    };
+
+    /*
+     *    ,    .     ,
+     *          .   
+     *    ,      
+     */
+    class InlinedCall : public Statement {
+    public:
+        InlinedCall(std::unique_ptr<MethodCall> call, std::vector<InlinedMethod> methods);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+    private:
+        //   .  nullopt,     
+        std::optional<runtime::ObjectHolder> Run(const InlinedMethod& method, runtime::ClassInstance& instance,
+                                                 runtime::Closure& closure, runtime::Context& context);
+
+        std::unique_ptr<MethodCall> call_;
+        std::vector<InlinedMethod> methods_;
+        //  ,       Mython
+        bool borrow_object_;
+    };
+
+    //    
+    struct InlineStats {
+        size_t getters = 0;
+        size_t setters = 0;
+
+        void Print(std::ostream& out) const;
+    };
+
+    /*
+     *   (return self.field)   (self.field = param)    .
+     *     ,    object.method(args)  
+     *  ,   method     -   .  
+     *     .      (. Fuse):
+     *       ,     
+     */
+    InlineStats InlineMethods(std::unique_ptr<Statement>& root);
+
+    /*
+     *      classes     node,   
+     * min_calls  (. MethodCall::GetCalls).       
+     *  :  ,   ,   
+     */
+    InlineStats InlineCalls(std::unique_ptr<Statement>& node, const std::vector<const runtime::Class*>& classes,
+                            std::int64_t min_calls = 0);
+
+}  // namespace ast
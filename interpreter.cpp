@@ -0,0 +1,180 @@
+#include "interpreter.h"
+
+#include "lexer.h"
+#include "native.h"
+#include "parse.h"
+#include "runtime.h"
+#include "statement.h"
+#include "transpiler.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace interpreter {
+
+    namespace {
+
+        //   .     ,     
+        class WorkQueue {
+        public:
+            void Push(size_t job) {
+                lock_guard guard(mutex_);
+                jobs_.push_back(job);
+            }
+
+            optional<size_t> Pop() {
+                lock_guard guard(mutex_);
+                if (jobs_.empty()) return nullopt;
+                const size_t job = jobs_.front();
+                jobs_.pop_front();
+                return job;
+            }
+
+            optional<size_t> Steal() {
+                lock_guard guard(mutex_);
+                if (jobs_.empty()) return nullopt;
+                const size_t job = jobs_.back();
+                jobs_.pop_back();
+                return job;
+            }
+
+        private:
+            mutex mutex_;
+            deque<size_t> jobs_;
+        };
+
+    }  // namespace
+
+    Program::Program(unique_ptr<runtime::Executable> body) noexcept
+        : body_(move(body)) {
+    }
+
+    Program::~Program() = default;
+
+    shared_ptr<const Program> Program::Parse(istream& input, const ParseOptions& options) {
+        parse::Lexer lexer(input);
+        auto program = make_shared<Program>(ParseProgram(lexer));
+        //  C++      ,     
+        if (!options.native_module.empty()) {
+            program->native_methods_ = native::LoadModule(options.native_module, program->body_);
+        }
+        if (options.tiering) {
+            tiering::TieringOptions tiering = *options.tiering;
+            tiering.inlining = options.inlining;
+            tiering.fusion = options.fusion;
+            program->tiering_ = make_unique<tiering::TieringManager>(program->body_, tiering);
+            return program;
+        }
+        //      ,     
+        if (options.inlining) {
+            program->inline_stats_ = ast::InlineMethods(program->body_);
+        }
+        if (options.fusion) {
+            program->fusion_stats_ = ast::Fuse(program->body_);
+        }
+        // JIT      ,      
+        if (options.jit) {
+            program->jit_methods_ = jit::EnableJit(program->body_, *options.jit);
+        }
+        return program;
+    }
+
+    tiering::TierStats Program::GetTierStats() const {
+        return tiering_ ? tiering_->GetStats() : tiering::TierStats{};
+    }
+
+    jit::JitStats Program::GetJitStats() const {
+        return jit::GetStats(jit_methods_);
+    }
+
+    void Program::EmitCpp(istream& input, ostream& output) {
+        parse::Lexer lexer(input);
+        const auto body = ParseProgram(lexer);
+        native::EmitModule(*body, output);
+    }
+
+    void Program::Run(runtime::OutputSink& output, const Variables& variables, const RunOptions& options) const {
+        //          
+        runtime::Heap heap(options.heap);
+        runtime::HeapScope heap_scope(heap);
+
+        runtime::SimpleContext context{ output };
+        runtime::Closure closure;
+        Bind(closure, variables);
+        Execute(closure, context);
+        output.Flush();
+
+        if (options.heap_stats) {
+            heap.PrintStats(*options.heap_stats);
+        }
+    }
+
+    void Program::Execute(runtime::Closure& closure, runtime::Context& context) const {
+        try {
+            body_->Execute(closure, context);
+        }
+        catch (ast::ReturnException& e) {
+            //     ,     .  
+            //  ,  return     
+            e.TakeValue();
+            throw runtime_error("Return outside of a method"s);
+        }
+    }
+
+    void Program::Bind(runtime::Closure& closure, const Variables& variables) {
+        for (const auto& [name, value] : variables) {
+            closure[name] = runtime::ObjectHolder::Own(runtime::String(value));
+        }
+    }
+
+    vector<JobResult> RunJobs(const vector<Job>& jobs, size_t threads, const RunOptions& options) {
+        vector<JobResult> results(jobs.size());
+        threads = clamp<size_t>(threads, 1, max<size_t>(jobs.size(), 1));
+
+        vector<WorkQueue> queues(threads);
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            queues[i % threads].Push(i);
+        }
+
+        auto run_job = [&](size_t index) {
+            runtime::StringOutput output;
+            try {
+                jobs[index].program->Run(output, jobs[index].variables, options);
+            }
+            catch (...) {
+                results[index].error = current_exception();
+            }
+            results[index].output = output.TakeString();
+        };
+
+        //    ,   ,       
+        auto worker = [&](size_t self) {
+            for (;;) {
+                optional<size_t> job = queues[self].Pop();
+                for (size_t i = 1; !job && i < threads; ++i) {
+                    job = queues[(self + i) % threads].Steal();
+                }
+                if (!job) return;
+                run_job(*job);
+            }
+        };
+
+        vector<thread> workers;
+        workers.reserve(threads - 1);
+        for (size_t i = 1; i < threads; ++i) {
+            workers.emplace_back(worker, i);
+        }
+        worker(0);
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        return results;
+    }
+
+}  // namespace interpreter
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "fusion.h"
+#include "heap.h"
+#include "inliner.h"
+#include "jit.h"
+#include "output.h"
+#include "runtime.h"
+#include "tiering.h"
+
+#include <exception>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace interpreter {
+
+    //     .    
+    using Variables = std::vector<std::pair<std::string, std::string>>;
+
+    //    
+    struct RunOptions {
+        runtime::HeapOptions heap;
+        //  ,        
+        std::ostream* heap_stats = nullptr;
+    };
+
+    //   
+    struct ParseOptions {
+        //        (. ast::InlineMethods)
+        bool inlining = true;
+        //       (. ast::Fuse)
+        bool fusion = true;
+        //  ,        (. jit::EnableJit)
+        std::optional<jit::JitOptions> jit;
+        //  ,      C++    (. native::LoadModule)
+        std::string native_module;
+        //  ,    ,   JIT      , 
+        //    (. tiering::TieringManager).  inlining  fusion   
+        // ,  jit  
+        std::optional<tiering::TieringOptions> tiering;
+    };
+
+    /*
+     *   Mython.     ,   
+     *    ,       .
+     *     , Closure  Context
+     */
+    class Program {
+    public:
+        explicit Program(std::unique_ptr<runtime::Executable> body) noexcept;
+        ~Program();
+
+        //   .   ParseError  parse::LexerError
+        static std::shared_ptr<const Program> Parse(std::istream& input, const ParseOptions& options = {});
+
+        //       output  C++    (. native::EmitModule)
+        static void EmitCpp(std::istream& input, std::ostream& output);
+
+        //  ,    print  output
+        void Run(runtime::OutputSink& output, const Variables& variables = {}, const RunOptions& options = {}) const;
+
+        //     closure  context.   :  
+        //    
+        void Execute(runtime::Closure& closure, runtime::Context& context) const;
+
+        //   variables    closure
+        static void Bind(runtime::Closure& closure, const Variables& variables);
+
+        //      ,    
+        [[nodiscard]] const ast::FusionStats& GetFusionStats() const noexcept {
+            return fusion_stats_;
+        }
+
+        //    ,       
+        [[nodiscard]] const ast::InlineStats& GetInlineStats() const noexcept {
+            return inline_stats_;
+        }
+
+        //   ,      C++
+        [[nodiscard]] size_t GetNativeMethods() const noexcept {
+            return native_methods_;
+        }
+
+        //       .     
+        [[nodiscard]] tiering::TierStats GetTierStats() const;
+
+        //   ,  JIT    (. ParseOptions::jit).
+        //         
+        [[nodiscard]] jit::JitStats GetJitStats() const;
+
+    private:
+        //        , 
+        //     
+        std::unique_ptr<tiering::TieringManager> tiering_;
+        std::unique_ptr<runtime::Executable> body_;
+        ast::InlineStats inline_stats_;
+        ast::FusionStats fusion_stats_;
+        size_t native_methods_ = 0;
+        std::vector<const jit::JitMethod*> jit_methods_;
+    };
+
+    //    
+    struct Job {
+        std::shared_ptr<const Program> program;
+        Variables variables;
+    };
+
+    struct JobResult {
+        std::string output;
+        // ,   ,  nullptr
+        std::exception_ptr error;
+    };
+
+    /*
+     *    threads       .
+     *     ,      
+     *  ,         
+     */
+    std::vector<JobResult> RunJobs(const std::vector<Job>& jobs, size_t threads, const RunOptions& options = {});
+
+}  // namespace interpreter
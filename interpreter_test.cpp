@@ -0,0 +1,565 @@
+#include "interpreter.h"
+#include "lexer.h"
+#include "native.h"
+#include "parse.h"
+#include "task.h"
+#include "test_runner_p.h"
+#include "transpiler.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace interpreter {
+
+    namespace {
+
+        shared_ptr<const Program> ParseString(const string& text) {
+            istringstream input(text);
+            return Program::Parse(input);
+        }
+
+        void TestProgramRunsRepeatedly() {
+            const auto program = ParseString(R"(
+class Greeter:
+  def greet(name):
+    return 'hello, ' + name
+
+g = Greeter()
+print g.greet(input)
+)"s);
+
+            runtime::StringOutput first;
+            program->Run(first, { {"input"s, "world"s} });
+            runtime::StringOutput second;
+            program->Run(second, { {"input"s, "again"s} });
+
+            ASSERT_EQUAL(first.GetString(), "hello, world\n"s);
+            ASSERT_EQUAL(second.GetString(), "hello, again\n"s);
+        }
+
+        void TestTopLevelReturnIsError() {
+            //           
+            const auto program = ParseString(R"(
+class A:
+  def m():
+    return 1
+
+print 'before'
+return A()
+)"s);
+
+            runtime::StringOutput output;
+            ASSERT_THROWS(program->Run(output), runtime_error);
+            ASSERT_EQUAL(output.GetString(), "before\n"s);
+
+            runtime::StringOutput task_output;
+            {
+                Task task(program, task_output);
+                ASSERT(task.Resume());
+                ASSERT(task.GetState() == TaskState::FAILED);
+                ASSERT_THROWS(rethrow_exception(task.GetError()), runtime_error);
+            }
+            ASSERT_EQUAL(task_output.GetString(), "before\n"s);
+        }
+
+        void TestRunJobsKeepsOrder() {
+            //     : ,   ,  
+            const auto heavy = ParseString(R"(
+class Counter:
+  def count(n):
+    if n > 0:
+      return self.count(n - 1) + 1
+    return 0
+
+c = Counter()
+i = c.count(2000)
+print input, i
+)"s);
+            const auto light = ParseString("print input\n"s);
+            const auto broken = ParseString("print 1 / 0\n"s);
+
+            vector<Job> jobs;
+            string expected;
+            for (int i = 0; i < 64; ++i) {
+                const string input = to_string(i);
+                if (i % 8 == 0) {
+                    jobs.push_back({ heavy, { {"input"s, input} } });
+                    expected += input + " 2000\n"s;
+                }
+                else {
+                    jobs.push_back({ light, { {"input"s, input} } });
+                    expected += input + "\n"s;
+                }
+            }
+            jobs.push_back({ broken, {} });
+
+            const auto results = RunJobs(jobs, 4);
+            ASSERT_EQUAL(results.size(), jobs.size());
+
+            string output;
+            for (size_t i = 0; i + 1 < results.size(); ++i) {
+                ASSERT(!results[i].error);
+                output += results[i].output;
+            }
+            ASSERT_EQUAL(output, expected);
+            ASSERT(results.back().error != nullptr);
+            ASSERT_THROWS(rethrow_exception(results.back().error), runtime_error);
+        }
+
+        void TestTasksShareThread() {
+            const auto program = ParseString(R"(
+class Printer:
+  def run(name, n):
+    if n > 0:
+      print name, n
+      return self.run(name, n - 1)
+    return 0
+
+p = Printer()
+x = p.run(name, 3)
+)"s);
+
+            runtime::StringOutput output;
+            Scheduler scheduler;
+            TaskOptions options;
+            options.slice_steps = 4;
+            scheduler.Spawn(program, output, { {"name"s, "a"s} }, options);
+            scheduler.Spawn(program, output, { {"name"s, "b"s} }, options);
+            scheduler.Run();
+
+            //   ,    
+            ASSERT_EQUAL(output.GetString(), "a 3\nb 3\na 2\nb 2\na 1\nb 1\n"s);
+            for (const auto& task : scheduler.GetTasks()) {
+                ASSERT(task->GetState() == TaskState::FINISHED);
+            }
+        }
+
+        void TestTaskLimits() {
+            const auto endless = ParseString(R"(
+class Runaway:
+  def run(n):
+    return self.run(n + 1) + 1
+
+r = Runaway()
+x = r.run(0)
+)"s);
+
+            runtime::StringOutput output;
+            TaskOptions options;
+            options.slice_steps = 100;
+            options.step_limit = 1000;
+            //     1000      AddressSanitizer,   
+            options.stack_size = 8 * 1024 * 1024;
+            Task limited(endless, output, {}, options);
+            while (!limited.Resume()) {
+            }
+            ASSERT(limited.GetState() == TaskState::FAILED);
+            ASSERT_THROWS(rethrow_exception(limited.GetError()), StepLimitExceeded);
+            ASSERT_EQUAL(limited.GetSteps(), 1000);
+
+            //       
+            options.step_limit = 0;
+            options.slice_steps = 1'000'000;
+            options.stack_size = 512 * 1024;
+            Task deep(endless, output, {}, options);
+            ASSERT(deep.Resume());
+            ASSERT(deep.GetState() == TaskState::FAILED);
+            ASSERT_THROWS(rethrow_exception(deep.GetError()), runtime_error);
+
+            options.slice_steps = 10;
+            Task cancelled(endless, output, {}, options);
+            ASSERT(!cancelled.Resume());
+            cancelled.Cancel();
+            ASSERT(cancelled.Resume());
+            ASSERT(cancelled.GetState() == TaskState::CANCELLED);
+            ASSERT(!cancelled.GetError());
+
+            //       
+            {
+                Task abandoned(endless, output, {}, options);
+                ASSERT(!abandoned.Resume());
+                ASSERT(!abandoned.Resume());
+            }
+        }
+
+        void TestInlinedAccessorsMatchCalls() {
+            const string text = R"(
+class Box:
+  def __init__(v):
+    self.value = v
+
+  def get():
+    return self.value
+
+  def set(v):
+    self.value = v
+
+class Labeled(Box):
+  def __str__():
+    return 'box'
+
+class Doubled(Box):
+  def get():
+    return self.value * 2
+
+boxes = Box(1)
+labeled = Labeled(2)
+doubled = Doubled(3)
+total = 0
+for i in range(4):
+  boxes.set(i)
+  labeled.set(labeled.get() + i)
+  doubled.set(i)
+  total = total + boxes.get() + labeled.get() + doubled.get()
+print total, labeled, labeled.get(), doubled.get()
+empty = Box(0)
+empty.value = None
+print empty.get()
+)"s;
+            istringstream inlined_input(text);
+            const auto inlined = Program::Parse(inlined_input);
+            //  Doubled  get,       
+            ASSERT_EQUAL(inlined->GetInlineStats().getters, 7U);
+            ASSERT_EQUAL(inlined->GetInlineStats().setters, 3U);
+
+            istringstream called_input(text);
+            ParseOptions options;
+            options.inlining = false;
+            const auto called = Program::Parse(called_input, options);
+            ASSERT_EQUAL(called->GetInlineStats().getters, 0U);
+
+            runtime::StringOutput inlined_output;
+            inlined->Run(inlined_output);
+            runtime::StringOutput called_output;
+            called->Run(called_output);
+            ASSERT_EQUAL(inlined_output.GetString(), "36 box 8 6\nNone\n"s);
+            ASSERT_EQUAL(inlined_output.GetString(), called_output.GetString());
+        }
+
+        void TestJitMatchesInterpreter() {
+            const string text = R"(
+class Math:
+  def __init__(base):
+    self.base = base
+
+  def sum_squares(n):
+    total = 0
+    for i in range(n):
+      total = total + i * i + self.base
+    return total
+
+  def steps(n):
+    count = 0
+    while n != 1:
+      if n - n / 2 * 2 == 0:
+        n = n / 2
+      else:
+        n = 3 * n + 1
+      count = count + 1
+    return count
+
+  def scale(x):
+    return x * 1000000000000
+
+  def twice(x):
+    return x + x
+
+m = Math(1)
+for i in range(3):
+  print m.sum_squares(10), m.steps(27), m.scale(i)
+print m.scale(10000000000), m.twice(2), m.twice('a')
+m.base = 'x'
+print m.sum_squares(0)
+m.base = 10000000000000000000000
+print m.sum_squares(3)
+)"s;
+            istringstream jit_input(text);
+            ParseOptions options;
+            options.jit = jit::JitOptions{ .threshold = 1 };
+            const auto compiled = Program::Parse(jit_input, options);
+            istringstream plain_input(text);
+            const auto interpreted = Program::Parse(plain_input);
+
+            // ,    ,     int64_t, 
+            //  
+            runtime::StringOutput compiled_output;
+            compiled->Run(compiled_output);
+            runtime::StringOutput interpreted_output;
+            interpreted->Run(interpreted_output);
+            ASSERT_EQUAL(compiled_output.GetString(), interpreted_output.GetString());
+            ASSERT_EQUAL(compiled_output.GetString(), "295 111 0\n295 111 1000000000000\n295 111 2000000000000\n"
+                                                      "10000000000000000000000 4 aa\n0\n30000000000000000000005\n"s);
+
+            const jit::JitStats stats = compiled->GetJitStats();
+            ASSERT_EQUAL(interpreted->GetJitStats().methods, 0u);
+            if (!jit::IsSupported()) {
+                ASSERT_EQUAL(stats.methods, 0u);
+                return;
+            }
+            // __init__      
+            ASSERT_EQUAL(stats.methods, 4u);
+            ASSERT_EQUAL(stats.compiled, 4u);
+            // scale(10000000000) , twice('a')  , sum_squares(3) 
+            //    
+            ASSERT_EQUAL(stats.deopts, 3);
+        }
+
+        void TestTieringMatchesInterpreter() {
+            const string text = R"(
+class Point:
+  def __init__(x):
+    self.x = x
+
+  def get_x():
+    return self.x
+
+  def sum(n):
+    total = 0
+    for i in range(n):
+      total = total + i * self.x
+    return total
+
+  def label():
+    return 'p' + str(self.get_x())
+
+  def count(n, acc):
+    if n == 0:
+      return acc
+    return self.count(n - 1, acc + 1)
+
+  def unused():
+    return 0
+
+p = Point(2)
+for i in range(5):
+  print p.sum(10), p.label(), p.count(100, 0)
+)"s;
+            istringstream tiered_input(text);
+            ParseOptions options;
+            options.tiering = tiering::TieringOptions{ .warm = 2, .hot = 4 };
+            const auto tiered = Program::Parse(tiered_input, options);
+            const auto interpreted = ParseString(text);
+            ASSERT_EQUAL(tiered->GetTierStats().cold, 6u);
+
+            //      : ,   ,   
+            // ,    
+            runtime::StringOutput tiered_output;
+            tiered->Run(tiered_output);
+            runtime::StringOutput interpreted_output;
+            interpreted->Run(interpreted_output);
+            ASSERT_EQUAL(tiered_output.GetString(), interpreted_output.GetString());
+            ASSERT_EQUAL(tiered_output.GetString(), "90 p2 100\n90 p2 100\n90 p2 100\n90 p2 100\n90 p2 100\n"s);
+
+            // __init__  unused   ,  get_x      label.
+            // sum  JIT, label  count    
+            const tiering::TierStats stats = tiered->GetTierStats();
+            const size_t compiled = jit::IsSupported() ? 1 : 0;
+            ASSERT_EQUAL(stats.cold, 3u);
+            ASSERT_EQUAL(stats.uncopyable, 0u);
+            ASSERT_EQUAL(stats.warm, 3u - compiled);
+            ASSERT_EQUAL(stats.hot, compiled);
+            ASSERT_EQUAL(stats.compiled, compiled);
+
+            //     -    
+            const vector<Job> jobs(8, Job{ tiered, {} });
+            for (const JobResult& result : RunJobs(jobs, 4)) {
+                ASSERT(!result.error);
+                ASSERT_EQUAL(result.output, interpreted_output.GetString());
+            }
+        }
+
+        void TestTieringReportsUncopyableMethods() {
+            istringstream input(R"(
+class Counter:
+  def step(n):
+    n = n + 1
+    return n
+
+  def big():
+    return 100000000000000000000
+
+c = Counter()
+for i in range(3):
+  print c.step(i), c.big()
+)"s);
+            parse::Lexer lexer(input);
+            auto root = ParseProgram(lexer);
+            //    ,  step    COLD.  
+            // ,  big    WARM
+            ASSERT_EQUAL(ast::Fuse(root).GetCount("variable_increment"sv), 1u);
+            tiering::TieringManager manager(root, tiering::TieringOptions{ .warm = 1, .hot = 1000 });
+
+            runtime::Heap heap;
+            runtime::HeapScope heap_scope(heap);
+            runtime::StringOutput output;
+            runtime::SimpleContext context{ output };
+            runtime::Closure closure;
+            root->Execute(closure, context);
+            ASSERT_EQUAL(output.GetString(), "1 100000000000000000000\n2 100000000000000000000\n"
+                                             "3 100000000000000000000\n"s);
+
+            const tiering::TierStats stats = manager.GetStats();
+            ASSERT_EQUAL(stats.cold, 1u);
+            ASSERT_EQUAL(stats.uncopyable, 1u);
+            ASSERT_EQUAL(stats.warm, 1u);
+            ostringstream printed;
+            stats.Print(printed);
+            ASSERT_EQUAL(printed.str(), "tiers: cold 1 (uncopyable 1), warm 1, hot 0 (compiled 0)\n"s);
+        }
+
+        void TestEmitCppDescribesMethods() {
+            const string text = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add(n):
+    self.value = self.value + n
+    return self.value
+
+c = Counter()
+print c.add(2)
+)"s;
+            auto emit = [&text] {
+                istringstream input(text);
+                ostringstream output;
+                Program::EmitCpp(input, output);
+                return output.str();
+            };
+            const string module = emit();
+            ASSERT(module.find("// Counter.add(n)"s) != string::npos);
+            ASSERT(module.find("extern \"C\" const native::Module mython_module"s) != string::npos);
+            //      :     
+            ASSERT_EQUAL(emit(), module);
+
+            istringstream input(text);
+            ParseOptions options;
+            options.native_module = "no-such-module.so"s;
+            ASSERT_THROWS(Program::Parse(input, options), runtime_error);
+        }
+
+        void TestNativeModuleMustMatchProgram() {
+            istringstream input(R"(
+class Counter:
+  def add(n):
+    return n + 1
+)"s);
+            parse::Lexer lexer(input);
+            const auto root = ParseProgram(lexer);
+            const native::ModuleMethod methods[] = { { 0, 0, "add", nullptr } };
+            const native::Module module{ native::ABI_VERSION, native::ModuleFingerprint(*root), 1, methods, 1 };
+            ASSERT_EQUAL(native::CheckModule(module, *root, "module.so"s).size(), 1u);
+
+            native::Module other_version = module;
+            ++other_version.abi_version;
+            ASSERT_THROWS(native::CheckModule(other_version, *root, "module.so"s), runtime_error);
+            native::Module other_program = module;
+            ++other_program.fingerprint;
+            ASSERT_THROWS(native::CheckModule(other_program, *root, "module.so"s), runtime_error);
+            const native::ModuleMethod renamed[] = { { 0, 0, "sub", nullptr } };
+            native::Module other_method = module;
+            other_method.methods = renamed;
+            ASSERT_THROWS(native::CheckModule(other_method, *root, "module.so"s), runtime_error);
+        }
+
+        //   ,    MYTHON_TEST_CXX,   .
+        //      ,      ,
+        //    ,        
+        void TestNativeModuleMatchesInterpreter() {
+            const char* compiler = getenv("MYTHON_TEST_CXX");
+            if (!compiler || !native::IsSupported()) return;
+
+            const string text = R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add(n):
+    self.value = self.value + n
+    return self.value
+
+  def sum(n):
+    total = 0
+    for i in range(n):
+      total = total + self.add(i)
+    return total
+
+  def count(n, acc):
+    if n == 0:
+      return acc
+    return self.count(n - 1, acc + 1)
+
+  def noisy():
+    print 'noisy'
+    return 1
+
+  def fail():
+    return self.nosuch(self.noisy())
+
+c = Counter()
+print c.add(2), c.sum(5), c.count(1000, 0), c.add(1)
+x = c.fail()
+)"s;
+            namespace fs = std::filesystem;
+            const fs::path directory = fs::temp_directory_path()
+                / ("mython-module-"s + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+            fs::create_directories(directory);
+            const fs::path source = directory / "module.cpp";
+            const fs::path library = directory / "module.so";
+            {
+                istringstream input(text);
+                ofstream output(source);
+                Program::EmitCpp(input, output);
+            }
+            //       
+            const fs::path headers = fs::path(__FILE__).parent_path();
+            const string command = string(compiler) + " -std=c++20 -shared -fPIC -I'"s
+                + (headers.empty() ? "."s : headers.string()) + "' '"s + source.string() + "' -o '"s + library.string() + "'"s;
+            ASSERT_EQUAL(system(command.c_str()), 0);
+
+            ParseOptions options;
+            options.native_module = library.string();
+            istringstream native_input(text);
+            const auto native = Program::Parse(native_input, options);
+            // ,    ,  
+            string changed = text;
+            changed.replace(changed.find("self.value + n"s), "self.value + n"s.size(), "self.value - n"s);
+            istringstream changed_input(changed);
+            ASSERT_THROWS(Program::Parse(changed_input, options), runtime_error);
+            fs::remove_all(directory);
+
+            ASSERT_EQUAL(native->GetNativeMethods(), 6u);
+            //       ,  
+            runtime::StringOutput native_output;
+            ASSERT_THROWS(native->Run(native_output), runtime_error);
+            runtime::StringOutput interpreted_output;
+            ASSERT_THROWS(ParseString(text)->Run(interpreted_output), runtime_error);
+            ASSERT_EQUAL(native_output.GetString(), interpreted_output.GetString());
+            ASSERT_EQUAL(native_output.GetString(), "2 30 1000 13\nnoisy\n"s);
+        }
+
+    }  // namespace
+
+    void RunInterpreterTests(TestRunner& tr) {
+        RUN_TEST(tr, interpreter::TestProgramRunsRepeatedly);
+        RUN_TEST(tr, interpreter::TestTopLevelReturnIsError);
+        RUN_TEST(tr, interpreter::TestRunJobsKeepsOrder);
+        RUN_TEST(tr, interpreter::TestTasksShareThread);
+        RUN_TEST(tr, interpreter::TestTaskLimits);
+        RUN_TEST(tr, interpreter::TestInlinedAccessorsMatchCalls);
+        RUN_TEST(tr, interpreter::TestJitMatchesInterpreter);
+        RUN_TEST(tr, interpreter::TestEmitCppDescribesMethods);
+        RUN_TEST(tr, interpreter::TestNativeModuleMustMatchProgram);
+        RUN_TEST(tr, interpreter::TestNativeModuleMatchesInterpreter);
+        RUN_TEST(tr, interpreter::TestTieringMatchesInterpreter);
+        RUN_TEST(tr, interpreter::TestTieringReportsUncopyableMethods);
+    }
+
+}  // namespace interpreter
@@ -0,0 +1,760 @@
+#include "jit.h"
+
+#include "fusion.h"
+#include "statement.h"
+
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#if defined(__linux__) && defined(__x86_64__)
+#define MYTHON_JIT_SUPPORTED
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace jit {
+
+    namespace {
+
+        //    
+        enum Status : int {
+            RETURNED_NONE = 0,
+            //   ,    RESULT_SLOT
+            RETURNED_NUMBER = 1,
+            //    ,    
+            DEOPTIMIZED = 2,
+        };
+
+        //    .      ,
+        //     
+        constexpr int64_t UNDEFINED = numeric_limits<int64_t>::min();
+
+        //  -  int64_t,    rbx: , ,  
+        //    
+        constexpr size_t RESULT_SLOT = 0;
+        //  ,        
+        constexpr size_t INLINE_SLOTS = 32;
+
+    }  // namespace
+
+#ifdef MYTHON_JIT_SUPPORTED
+
+    namespace {
+
+        //   :    .  false,  
+        //     Number
+        bool LoadField(runtime::ClassInstance* self, const string* name, int64_t* value) noexcept {
+            const auto& fields = self->Fields();
+            const auto it = fields.find(*name);
+            if (it == fields.end()) return false;
+            const auto* number = it->second.TryAs<runtime::Number>();
+            if (!number) return false;
+            *value = number->GetValue();
+            return true;
+        }
+
+        // ,    
+        struct Unsupported {};
+
+        /*
+         *       x86-64 (System V).     
+         * .     int(int64_t* slots, ClassInstance* self):
+         * rbx   , r12 -  ,     rax,  
+         *     .       deopt
+         */
+        class Compiler {
+        public:
+            explicit Compiler(const vector<string>& formal_params) {
+                for (const string& param : formal_params) {
+                    //      
+                    distinct_params_ = slots_.emplace(param, slot_count_++).second && distinct_params_;
+                }
+                parameter_slots_ = slot_count_;
+            }
+
+            //   .  false,      
+            bool Compile(const runtime::Executable& body) {
+                try {
+                    const auto* method_body = dynamic_cast<const ast::MethodBody*>(&body);
+                    if (!method_body || !distinct_params_) throw Unsupported{};
+
+                    // push rbp; mov rbp, rsp; push rbx; push r12; mov rbx, rdi; mov r12, rsi
+                    Emit({ 0x55, 0x48, 0x89, 0xE5, 0x53, 0x41, 0x54, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4 });
+                    EmitStatement(method_body->GetBody());
+                    EmitReturnStatus(RETURNED_NONE);
+
+                    Bind(epilogue_);
+                    // lea rsp, [rbp - 16]; pop r12; pop rbx; pop rbp; ret
+                    Emit({ 0x48, 0x8D, 0x65, 0xF0, 0x41, 0x5C, 0x5B, 0x5D, 0xC3 });
+
+                    Bind(deopt_);
+                    EmitReturnStatus(DEOPTIMIZED);
+                    Jump(epilogue_);
+                    Resolve(epilogue_);
+                    Resolve(deopt_);
+                    return true;
+                }
+                catch (const Unsupported&) {
+                    return false;
+                }
+            }
+
+            [[nodiscard]] const vector<uint8_t>& GetCode() const noexcept {
+                return code_;
+            }
+
+            [[nodiscard]] size_t GetSlotCount() const noexcept {
+                return slot_count_;
+            }
+
+            [[nodiscard]] size_t GetParameterSlots() const noexcept {
+                return parameter_slots_;
+            }
+
+        private:
+            struct Label {
+                size_t position = numeric_limits<size_t>::max();
+                //  32-    
+                vector<size_t> fixups;
+            };
+
+            //       continue  break
+            struct Loop {
+                Label* next;
+                Label* exit;
+            };
+
+            void Emit(initializer_list<uint8_t> bytes) {
+                code_.insert(code_.end(), bytes);
+            }
+
+            template <typename T>
+            void EmitValue(T value) {
+                uint8_t bytes[sizeof(T)];
+                memcpy(bytes, &value, sizeof(T));
+                code_.insert(code_.end(), begin(bytes), end(bytes));
+            }
+
+            void EmitSlotDisplacement(size_t slot) {
+                EmitValue(static_cast<int32_t>(slot * sizeof(int64_t)));
+            }
+
+            // jmp  jcc  . opcode -     32- 
+            void EmitJump(initializer_list<uint8_t> opcode, Label& label) {
+                Emit(opcode);
+                label.fixups.push_back(code_.size());
+                EmitValue(int32_t{ 0 });
+            }
+
+            void Jump(Label& label) {
+                EmitJump({ 0xE9 }, label);
+            }
+
+            void JumpIfZero(Label& label) {
+                // test rax, rax; je label
+                Emit({ 0x48, 0x85, 0xC0 });
+                EmitJump({ 0x0F, 0x84 }, label);
+            }
+
+            void JumpIfOverflow() {
+                EmitJump({ 0x0F, 0x80 }, deopt_);
+            }
+
+            void Bind(Label& label) {
+                label.position = code_.size();
+            }
+
+            void Resolve(const Label& label) {
+                for (size_t fixup : label.fixups) {
+                    const auto offset = static_cast<int32_t>(label.position - (fixup + sizeof(int32_t)));
+                    memcpy(code_.data() + fixup, &offset, sizeof(offset));
+                }
+            }
+
+            void EmitReturnStatus(Status status) {
+                // mov eax, status
+                Emit({ 0xB8 });
+                EmitValue(static_cast<int32_t>(status));
+            }
+
+            // mov rax, value  mov rcx, value
+            void LoadConstant(int64_t value, bool to_rcx = false) {
+                if (value >= numeric_limits<int32_t>::min() && value <= numeric_limits<int32_t>::max()) {
+                    Emit({ 0x48, 0xC7, static_cast<uint8_t>(to_rcx ? 0xC1 : 0xC0) });
+                    EmitValue(static_cast<int32_t>(value));
+                }
+                else {
+                    Emit({ 0x48, static_cast<uint8_t>(to_rcx ? 0xB9 : 0xB8) });
+                    EmitValue(value);
+                }
+            }
+
+            void LoadSlot(size_t slot) {
+                // mov rax, [rbx + slot * 8]
+                Emit({ 0x48, 0x8B, 0x83 });
+                EmitSlotDisplacement(slot);
+            }
+
+            void StoreSlot(size_t slot) {
+                // mov [rbx + slot * 8], rax
+                Emit({ 0x48, 0x89, 0x83 });
+                EmitSlotDisplacement(slot);
+            }
+
+            size_t NewSlot() {
+                return slot_count_++;
+            }
+
+            size_t VariableSlot(const string& name) {
+                if (name == runtime::SELF_NAME) throw Unsupported{};
+                return slots_.emplace(name, slot_count_).second ? slot_count_++ : slots_.at(name);
+            }
+
+            //   deopt,  rax  UNDEFINED: mov rcx, rax; neg rcx; jo deopt
+            void CheckDefined() {
+                Emit({ 0x48, 0x89, 0xC1, 0x48, 0xF7, 0xD9 });
+                JumpIfOverflow();
+            }
+
+            void LoadVariable(const string& name) {
+                const size_t slot = VariableSlot(name);
+                LoadSlot(slot);
+                //      ,   
+                if (slot >= parameter_slots_) {
+                    CheckDefined();
+                }
+            }
+
+            //   rcx     ,   rax
+            void LoadVariableToRcx(const string& name) {
+                const size_t slot = VariableSlot(name);
+                // mov rcx, [rbx + slot * 8]
+                Emit({ 0x48, 0x8B, 0x8B });
+                EmitSlotDisplacement(slot);
+                if (slot >= parameter_slots_) {
+                    // mov rdx, rcx; neg rdx; jo deopt
+                    Emit({ 0x48, 0x89, 0xCA, 0x48, 0xF7, 0xDA });
+                    JumpIfOverflow();
+                }
+            }
+
+            void LoadVariable(const ast::VariableValue& variable) {
+                const auto& ids = variable.GetDottedIds();
+                if (ids.size() == 1) {
+                    LoadVariable(ids.front());
+                    return;
+                }
+                if (ids.size() != 2 || ids.front() != runtime::SELF_NAME) throw Unsupported{};
+
+                //     ,        
+                //  ,     
+                const auto [it, inserted] = field_slots_.emplace(ids.back(), slot_count_);
+                if (inserted) ++slot_count_;
+                const size_t slot = it->second;
+                Label loaded;
+                LoadSlot(slot);
+                // mov rcx, rax; neg rcx; jno loaded
+                Emit({ 0x48, 0x89, 0xC1, 0x48, 0xF7, 0xD9 });
+                EmitJump({ 0x0F, 0x81 }, loaded);
+
+                //  LoadField(self, &name, &slots[slot]).      16 
+                const bool align = stack_depth_ % 2 != 0;
+                if (align) Emit({ 0x48, 0x83, 0xEC, 0x08 });
+                Emit({ 0x4C, 0x89, 0xE7, 0x48, 0xBE });
+                EmitValue(reinterpret_cast<uintptr_t>(&ids.back()));
+                Emit({ 0x48, 0x8D, 0x93 });
+                EmitSlotDisplacement(slot);
+                Emit({ 0x48, 0xB8 });
+                EmitValue(reinterpret_cast<uintptr_t>(&LoadField));
+                Emit({ 0xFF, 0xD0 });
+                if (align) Emit({ 0x48, 0x83, 0xC4, 0x08 });
+                // test al, al; je deopt
+                Emit({ 0x84, 0xC0 });
+                EmitJump({ 0x0F, 0x84 }, deopt_);
+                LoadSlot(slot);
+                Bind(loaded);
+                Resolve(loaded);
+            }
+
+            //  :   rax,   rcx
+            void EmitOperands(const ast::Statement& lhs, const ast::Statement& rhs) {
+                if (const auto* constant = dynamic_cast<const ast::NumericConst*>(&rhs)) {
+                    EmitExpression(lhs);
+                    LoadConstant(constant->GetValue().GetValue(), true);
+                    return;
+                }
+                if (const auto* variable = dynamic_cast<const ast::VariableValue*>(&rhs);
+                    variable && variable->GetDottedIds().size() == 1) {
+                    EmitExpression(lhs);
+                    LoadVariableToRcx(variable->GetDottedIds().front());
+                    return;
+                }
+                EmitExpression(lhs);
+                // push rax
+                Emit({ 0x50 });
+                ++stack_depth_;
+                EmitExpression(rhs);
+                // mov rcx, rax; pop rax
+                Emit({ 0x48, 0x89, 0xC1, 0x58 });
+                --stack_depth_;
+            }
+
+            //  :    rax
+            void EmitExpression(const ast::Statement& node) {
+                if (const auto* constant = dynamic_cast<const ast::NumericConst*>(&node)) {
+                    LoadConstant(constant->GetValue().GetValue());
+                }
+                else if (const auto* variable = dynamic_cast<const ast::VariableValue*>(&node)) {
+                    LoadVariable(*variable);
+                }
+                else if (const auto* add = dynamic_cast<const ast::Add*>(&node)) {
+                    EmitOperands(add->GetLhs(), add->GetRhs());
+                    // add rax, rcx
+                    Emit({ 0x48, 0x01, 0xC8 });
+                    JumpIfOverflow();
+                }
+                else if (const auto* sub = dynamic_cast<const ast::Sub*>(&node)) {
+                    EmitOperands(sub->GetLhs(), sub->GetRhs());
+                    // sub rax, rcx
+                    Emit({ 0x48, 0x29, 0xC8 });
+                    JumpIfOverflow();
+                }
+                else if (const auto* mult = dynamic_cast<const ast::Mult*>(&node)) {
+                    EmitOperands(mult->GetLhs(), mult->GetRhs());
+                    // imul rax, rcx
+                    Emit({ 0x48, 0x0F, 0xAF, 0xC1 });
+                    JumpIfOverflow();
+                }
+                else if (const auto* div = dynamic_cast<const ast::Div*>(&node)) {
+                    EmitOperands(div->GetLhs(), div->GetRhs());
+                    // test rcx, rcx; je deopt; cmp rcx, -1; je deopt; cqo; idiv rcx
+                    Emit({ 0x48, 0x85, 0xC9 });
+                    EmitJump({ 0x0F, 0x84 }, deopt_);
+                    Emit({ 0x48, 0x83, 0xF9, 0xFF });
+                    EmitJump({ 0x0F, 0x84 }, deopt_);
+                    Emit({ 0x48, 0x99, 0x48, 0xF7, 0xF9 });
+                }
+                else {
+                    throw Unsupported{};
+                }
+            }
+
+            // cmp rax, rcx; setcc al; movzx eax, al
+            void EmitCompare(ast::CompareWithConstant::Operation operation) {
+                using Operation = ast::CompareWithConstant::Operation;
+                uint8_t setcc = 0;
+                switch (operation) {
+                case Operation::LESS:
+                    setcc = 0x9C;
+                    break;
+                case Operation::GREATER:
+                    setcc = 0x9F;
+                    break;
+                case Operation::EQUAL:
+                    setcc = 0x94;
+                    break;
+                case Operation::NOT_EQUAL:
+                    setcc = 0x95;
+                    break;
+                case Operation::LESS_OR_EQUAL:
+                    setcc = 0x9E;
+                    break;
+                case Operation::GREATER_OR_EQUAL:
+                    setcc = 0x9D;
+                    break;
+                }
+                Emit({ 0x48, 0x39, 0xC8, 0x0F, setcc, 0xC0, 0x0F, 0xB6, 0xC0 });
+            }
+
+            //  : 0  1  rax
+            void EmitCondition(const ast::Statement& node) {
+                if (const auto* comparison = dynamic_cast<const ast::Comparison*>(&node)) {
+                    const auto operation = ast::MatchComparator(comparison->GetComparator());
+                    if (!operation) throw Unsupported{};
+                    EmitOperands(comparison->GetLhs(), comparison->GetRhs());
+                    EmitCompare(*operation);
+                }
+                else if (const auto* compare = dynamic_cast<const ast::CompareWithConstant*>(&node)) {
+                    LoadVariable(compare->GetVariable());
+                    LoadConstant(compare->GetConstant(), true);
+                    EmitCompare(compare->GetOperation());
+                }
+                else if (const auto* or_operation = dynamic_cast<const ast::Or*>(&node)) {
+                    Label end;
+                    EmitCondition(or_operation->GetLhs());
+                    // test rax, rax; jne end
+                    Emit({ 0x48, 0x85, 0xC0 });
+                    EmitJump({ 0x0F, 0x85 }, end);
+                    EmitCondition(or_operation->GetRhs());
+                    Bind(end);
+                    Resolve(end);
+                }
+                else if (const auto* and_operation = dynamic_cast<const ast::And*>(&node)) {
+                    Label end;
+                    EmitCondition(and_operation->GetLhs());
+                    JumpIfZero(end);
+                    EmitCondition(and_operation->GetRhs());
+                    Bind(end);
+                    Resolve(end);
+                }
+                else if (const auto* not_operation = dynamic_cast<const ast::Not*>(&node)) {
+                    EmitCondition(not_operation->GetArgument());
+                    // xor eax, 1
+                    Emit({ 0x83, 0xF0, 0x01 });
+                }
+                else if (const auto* constant = dynamic_cast<const ast::BoolConst*>(&node)) {
+                    LoadConstant(constant->GetValue().GetValue() ? 1 : 0);
+                }
+                else {
+                    //  ,    : test rax, rax; setne al; movzx eax, al
+                    EmitExpression(node);
+                    Emit({ 0x48, 0x85, 0xC0, 0x0F, 0x95, 0xC0, 0x0F, 0xB6, 0xC0 });
+                }
+            }
+
+            void EmitReturn(const ast::Statement& value) {
+                if (dynamic_cast<const ast::None*>(&value)) {
+                    EmitReturnStatus(RETURNED_NONE);
+                }
+                else {
+                    EmitExpression(value);
+                    StoreSlot(RESULT_SLOT);
+                    EmitReturnStatus(RETURNED_NUMBER);
+                }
+                Jump(epilogue_);
+            }
+
+            //  
+            void EmitStatement(const ast::Statement& node) {
+                if (const auto* compound = dynamic_cast<const ast::Compound*>(&node)) {
+                    for (const auto& statement : compound->GetStatements()) {
+                        EmitStatement(*statement);
+                    }
+                }
+                else if (const auto* assignment = dynamic_cast<const ast::Assignment*>(&node)) {
+                    EmitExpression(assignment->GetValue());
+                    StoreSlot(VariableSlot(assignment->GetName()));
+                }
+                else if (const auto* increment = dynamic_cast<const ast::VariableIncrement*>(&node)) {
+                    LoadVariable(increment->GetName());
+                    LoadConstant(increment->GetDelta(), true);
+                    Emit({ 0x48, 0x01, 0xC8 });
+                    JumpIfOverflow();
+                    StoreSlot(VariableSlot(increment->GetName()));
+                }
+                else if (const auto* if_else = dynamic_cast<const ast::IfElse*>(&node)) {
+                    Label else_label;
+                    Label end;
+                    EmitCondition(if_else->GetCondition());
+                    JumpIfZero(else_label);
+                    EmitStatement(if_else->GetIfBody());
+                    Jump(end);
+                    Bind(else_label);
+                    if (const ast::Statement* else_body = if_else->GetElseBody()) {
+                        EmitStatement(*else_body);
+                    }
+                    Bind(end);
+                    Resolve(else_label);
+                    Resolve(end);
+                }
+                else if (const auto* loop = dynamic_cast<const ast::While*>(&node)) {
+                    Label next;
+                    Label exit;
+                    Bind(next);
+                    EmitCondition(loop->GetCondition());
+                    JumpIfZero(exit);
+                    loops_.push_back({ &next, &exit });
+                    EmitStatement(loop->GetBody());
+                    loops_.pop_back();
+                    Jump(next);
+                    Bind(exit);
+                    Resolve(next);
+                    Resolve(exit);
+                }
+                else if (const auto* range = dynamic_cast<const ast::ForRange*>(&node)) {
+                    const size_t counter = NewSlot();
+                    const size_t end_slot = NewSlot();
+                    EmitExpression(range->GetBegin());
+                    StoreSlot(counter);
+                    EmitExpression(range->GetEnd());
+                    StoreSlot(end_slot);
+
+                    Label check;
+                    Label next;
+                    Label exit;
+                    Bind(check);
+                    // mov rax, [counter]; cmp rax, [end]; jge exit
+                    LoadSlot(counter);
+                    Emit({ 0x48, 0x3B, 0x83 });
+                    EmitSlotDisplacement(end_slot);
+                    EmitJump({ 0x0F, 0x8D }, exit);
+                    StoreSlot(VariableSlot(range->GetVariable()));
+                    loops_.push_back({ &next, &exit });
+                    EmitStatement(range->GetBody());
+                    loops_.pop_back();
+                    Bind(next);
+                    //       : add rax, 1
+                    LoadSlot(counter);
+                    Emit({ 0x48, 0x83, 0xC0, 0x01 });
+                    StoreSlot(counter);
+                    Jump(check);
+                    Bind(exit);
+                    Resolve(check);
+                    Resolve(next);
+                    Resolve(exit);
+                }
+                else if (dynamic_cast<const ast::Break*>(&node)) {
+                    if (loops_.empty()) throw Unsupported{};
+                    Jump(*loops_.back().exit);
+                }
+                else if (dynamic_cast<const ast::Continue*>(&node)) {
+                    if (loops_.empty()) throw Unsupported{};
+                    Jump(*loops_.back().next);
+                }
+                else if (const auto* ret = dynamic_cast<const ast::Return*>(&node)) {
+                    EmitReturn(ret->GetStatement());
+                }
+                else if (const auto* ret_variable = dynamic_cast<const ast::ReturnVariable*>(&node)) {
+                    EmitReturn(ret_variable->GetVariable());
+                }
+                else {
+                    throw Unsupported{};
+                }
+            }
+
+            vector<uint8_t> code_;
+            unordered_map<string, size_t> slots_;
+            size_t slot_count_ = RESULT_SLOT + 1;
+            size_t parameter_slots_ = 0;
+            bool distinct_params_ = true;
+            // ,      self
+            unordered_map<string, size_t> field_slots_;
+            //  ,     
+            size_t stack_depth_ = 0;
+            vector<Loop> loops_;
+            Label epilogue_;
+            Label deopt_;
+        };
+
+    }  // namespace
+
+    class CompiledCode {
+    public:
+        using Function = int (*)(int64_t* slots, runtime::ClassInstance* self);
+
+        explicit CompiledCode(const Compiler& compiler)
+            : slot_count_(compiler.GetSlotCount())
+            , parameter_slots_(compiler.GetParameterSlots()) {
+            const auto& code = compiler.GetCode();
+            const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_ = (code.size() + page - 1) / page * page;
+            void* memory = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) throw runtime_error("Failed to allocate memory for compiled code");
+            memcpy(memory, code.data(), code.size());
+            //           
+            if (mprotect(memory, size_, PROT_READ | PROT_EXEC) != 0) {
+                munmap(memory, size_);
+                throw runtime_error("Failed to make compiled code executable");
+            }
+            memory_ = memory;
+        }
+
+        ~CompiledCode() {
+            munmap(memory_, size_);
+        }
+
+        CompiledCode(const CompiledCode&) = delete;
+        CompiledCode& operator=(const CompiledCode&) = delete;
+
+        int Run(int64_t* slots, runtime::ClassInstance& self) const {
+            return reinterpret_cast<Function>(memory_)(slots, &self);
+        }
+
+        [[nodiscard]] size_t GetSlotCount() const noexcept {
+            return slot_count_;
+        }
+
+        [[nodiscard]] size_t GetParameterSlots() const noexcept {
+            return parameter_slots_;
+        }
+
+    private:
+        void* memory_ = nullptr;
+        size_t size_ = 0;
+        size_t slot_count_;
+        size_t parameter_slots_;
+    };
+
+    bool IsSupported() noexcept {
+        return true;
+    }
+
+#else
+
+    class CompiledCode {
+    public:
+        int Run(int64_t* /*slots*/, runtime::ClassInstance& /*self*/) const {
+            return DEOPTIMIZED;
+        }
+
+        [[nodiscard]] size_t GetSlotCount() const noexcept {
+            return RESULT_SLOT + 1;
+        }
+
+        [[nodiscard]] size_t GetParameterSlots() const noexcept {
+            return RESULT_SLOT + 1;
+        }
+    };
+
+    bool IsSupported() noexcept {
+        return false;
+    }
+
+#endif
+
+    JitMethod::JitMethod(vector<string> formal_params, unique_ptr<runtime::Executable> body, const JitOptions& options)
+        : formal_params_(move(formal_params))
+        , body_(move(body))
+        , options_(options) {
+    }
+
+    JitMethod::~JitMethod() = default;
+
+    runtime::ObjectHolder JitMethod::Execute(runtime::Closure& closure, runtime::Context& context) {
+        return body_->Execute(closure, context);
+    }
+
+    bool JitMethod::TryCall(runtime::ClassInstance& self, span<const runtime::ObjectHolder> args,
+                            runtime::Context& /*context*/, runtime::ObjectHolder& result) {
+        if (disabled_.load(memory_order_relaxed)) return false;
+        const CompiledCode* code = published_.load(memory_order_acquire);
+        if (!code) {
+            const int64_t calls = calls_.load(memory_order_relaxed) + 1;
+            calls_.store(calls, memory_order_relaxed);
+            if (calls < options_.threshold || !(code = Compile())) return false;
+        }
+        if (runtime::StepBudget::IsActive()) return false;
+
+        int64_t inline_slots[INLINE_SLOTS];
+        vector<int64_t> heap_slots;
+        int64_t* slots = inline_slots;
+        if (code->GetSlotCount() > INLINE_SLOTS) {
+            heap_slots.resize(code->GetSlotCount());
+            slots = heap_slots.data();
+        }
+        slots[RESULT_SLOT] = 0;
+        for (size_t i = 0; i < args.size(); ++i) {
+            const auto* number = args[i].TryAs<runtime::Number>();
+            if (!number) {
+                Deoptimize();
+                return false;
+            }
+            slots[RESULT_SLOT + 1 + i] = number->GetValue();
+        }
+        fill(slots + code->GetParameterSlots(), slots + code->GetSlotCount(), UNDEFINED);
+
+        switch (code->Run(slots, self)) {
+        case RETURNED_NONE:
+            result = runtime::ObjectHolder::None();
+            return true;
+        case RETURNED_NUMBER:
+            result = runtime::ObjectHolder::Own(runtime::Number{ slots[RESULT_SLOT] });
+            return true;
+        default:
+            Deoptimize();
+            return false;
+        }
+    }
+
+    void JitMethod::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(body_);
+    }
+
+    bool JitMethod::IsCompiled() const noexcept {
+        return published_.load(memory_order_acquire) != nullptr && !disabled_.load(memory_order_relaxed);
+    }
+
+    const CompiledCode* JitMethod::Compile() {
+        lock_guard guard(compile_mutex_);
+        if (const CompiledCode* code = published_.load(memory_order_acquire)) return code;
+        if (disabled_.load(memory_order_relaxed)) return nullptr;
+#ifdef MYTHON_JIT_SUPPORTED
+        Compiler compiler(formal_params_);
+        if (compiler.Compile(*body_)) {
+            try {
+                code_ = make_unique<CompiledCode>(compiler);
+                published_.store(code_.get(), memory_order_release);
+                return code_.get();
+            }
+            catch (const runtime_error&) {
+            }
+        }
+#endif
+        disabled_.store(true, memory_order_relaxed);
+        return nullptr;
+    }
+
+    void JitMethod::Deoptimize() noexcept {
+        // ,    ,   
+        if (deopts_.fetch_add(1, memory_order_relaxed) + 1 >= options_.max_deopts) {
+            disabled_.store(true, memory_order_relaxed);
+        }
+    }
+
+    bool CanCompile(const vector<string>& formal_params, const runtime::Executable& body) {
+#ifdef MYTHON_JIT_SUPPORTED
+        return Compiler(formal_params).Compile(body);
+#else
+        static_cast<void>(formal_params);
+        static_cast<void>(body);
+        return false;
+#endif
+    }
+
+    namespace {
+
+        void EnableInClasses(runtime::Executable& node, const JitOptions& options, vector<const JitMethod*>& methods) {
+            if (auto* definition = dynamic_cast<ast::ClassDefinition*>(&node)) {
+                for (runtime::Method& method : definition->GetClass().methods_) {
+                    if (CanCompile(method.formal_params, *method.body)) {
+                        auto body = make_unique<JitMethod>(method.formal_params, std::move(method.body), options);
+                        methods.push_back(body.get());
+                        method.body = std::move(body);
+                    }
+                }
+            }
+            node.VisitChildren([&options, &methods](unique_ptr<runtime::Executable>& child) {
+                EnableInClasses(*child, options, methods);
+            });
+        }
+
+    }  // namespace
+
+    vector<const JitMethod*> EnableJit(unique_ptr<runtime::Executable>& root, const JitOptions& options) {
+        vector<const JitMethod*> methods;
+        if (IsSupported() && root) {
+            EnableInClasses(*root, options, methods);
+        }
+        return methods;
+    }
+
+    void JitStats::Print(ostream& out) const {
+        out << "jit: methods "sv << methods << ", compiled "sv << compiled << ", deopts "sv << deopts << '\n';
+    }
+
+    JitStats GetStats(span<const JitMethod* const> methods) {
+        JitStats stats;
+        stats.methods = methods.size();
+        for (const JitMethod* method : methods) {
+            stats.compiled += method->IsCompiled() ? 1 : 0;
+            stats.deopts += method->GetDeopts();
+        }
+        return stats;
+    }
+
+}  // namespace jit
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace jit {
+
+    //  JIT-
+    struct JitOptions {
+        //   ,        
+        std::int64_t threshold = 1000;
+        //    ,       
+        std::int64_t max_deopts = 100;
+    };
+
+    //  true,  JIT-     (Linux x86-64)
+    [[nodiscard]] bool IsSupported() noexcept;
+
+    //        
+    class CompiledCode;
+
+    /*
+     *  ,   threshold      x86-64.
+     *
+     *  ,    :     - Number,
+     *    , , , if, while, for  return,   
+     *     (self.field).      : 
+     *     rax,    .   -  
+     *  .     ,     
+     *      (W^X).
+     *
+     *     :  - Number,  
+     * ,    ,  ,  - .   
+     * ,    ,      .
+     *   :       .
+     *       (. runtime::StepBudget),  
+     * ,   
+     */
+    class JitMethod : public runtime::Executable {
+    public:
+        JitMethod(std::vector<std::string> formal_params, std::unique_ptr<runtime::Executable> body,
+                  const JitOptions& options);
+        ~JitMethod() override;
+
+        //   
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool TryCall(runtime::ClassInstance& self, std::span<const runtime::ObjectHolder> args,
+                     runtime::Context& context, runtime::ObjectHolder& result) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        //  true,       
+        [[nodiscard]] bool IsCompiled() const noexcept;
+        //        
+        [[nodiscard]] std::int64_t GetDeopts() const noexcept {
+            return deopts_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        //  .  nullptr,     
+        const CompiledCode* Compile();
+        void Deoptimize() noexcept;
+
+        std::vector<std::string> formal_params_;
+        std::unique_ptr<runtime::Executable> body_;
+        JitOptions options_;
+
+        //      .    :
+        //      
+        std::atomic<std::int64_t> calls_ = 0;
+        std::atomic<std::int64_t> deopts_ = 0;
+        std::atomic<bool> disabled_ = false;
+        std::mutex compile_mutex_;
+        std::unique_ptr<CompiledCode> code_;
+        std::atomic<const CompiledCode*> published_ = nullptr;
+    };
+
+    //  true,  JIT     body   formal_params
+    [[nodiscard]] bool CanCompile(const std::vector<std::string>& formal_params, const runtime::Executable& body);
+
+    /*
+     *   ,    JIT,  JitMethod.  
+     *       ,     .
+     *   .  JIT  ,   
+     */
+    std::vector<const JitMethod*> EnableJit(std::unique_ptr<runtime::Executable>& root, const JitOptions& options);
+
+    //   JitMethod.     
+    struct JitStats {
+        size_t methods = 0;
+        // ,    
+        size_t compiled = 0;
+        //          
+        std::int64_t deopts = 0;
+
+        void Print(std::ostream& out) const;
+    };
+
+    [[nodiscard]] JitStats GetStats(std::span<const JitMethod* const> methods);
+
+}  // namespace jit
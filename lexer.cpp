@@ -20,6 +20,9 @@ namespace parse {
         if (lhs.Is<Number>()) {
             return lhs.As<Number>().value == rhs.As<Number>().value;
         }
+        if (lhs.Is<BigNumber>()) {
+            return lhs.As<BigNumber>().value == rhs.As<BigNumber>().value;
+        }
         if (lhs.Is<String>()) {
             return lhs.As<String>().value == rhs.As<String>().value;
         }
@@ -40,6 +43,7 @@ namespace parse {
     if (auto p = rhs.TryAs<type>()) return os << #type << '{' << p->value << '}';
 
         VALUED_OUTPUT(Number);
+        VALUED_OUTPUT(BigNumber);
         VALUED_OUTPUT(Id);
         VALUED_OUTPUT(String);
         VALUED_OUTPUT(Char);
@@ -68,6 +72,11 @@ namespace parse {
         UNVALUED_OUTPUT(None);
         UNVALUED_OUTPUT(True);
         UNVALUED_OUTPUT(False);
+        UNVALUED_OUTPUT(While);
+        UNVALUED_OUTPUT(For);
+        UNVALUED_OUTPUT(In);
+        UNVALUED_OUTPUT(Break);
+        UNVALUED_OUTPUT(Continue);
         UNVALUED_OUTPUT(Eof);
 
 #undef UNVALUED_OUTPUT
@@ -158,7 +167,12 @@ namespace parse {
         while (i < str.size() && str[i] >= '0' && str[i] <= '9') {
             value += str[i++];
         }
-        tokens_.push_back(token_type::Number{ stoi(value) });
+        try {
+            tokens_.push_back(token_type::Number{ stoll(value) });
+        }
+        catch (const std::out_of_range&) {
+            tokens_.push_back(token_type::BigNumber{ std::move(value) });
+        }
         str.erase(0, i);
 
     }
@@ -233,6 +247,16 @@ namespace parse {
             tokens_.push_back(token_type::True());
         else if (value == "False")
             tokens_.push_back(token_type::False());
+        else if (value == "while")
+            tokens_.push_back(token_type::While());
+        else if (value == "for")
+            tokens_.push_back(token_type::For());
+        else if (value == "in")
+            tokens_.push_back(token_type::In());
+        else if (value == "break")
+            tokens_.push_back(token_type::Break());
+        else if (value == "continue")
+            tokens_.push_back(token_type::Continue());
         else
             tokens_.push_back(token_type::Id{ value });
 
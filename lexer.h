@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iosfwd>
 #include <optional>
 #include <sstream>
@@ -12,7 +13,11 @@ namespace parse {
 
     namespace token_type {
         struct Number {  //  
-            int value;   // 
+            std::int64_t value;   // 
+        };
+
+        struct BigNumber {      //  ,    int64_t
+            std::string value;  //   
         };
 
         struct Id {             //  
@@ -47,15 +52,21 @@ namespace parse {
         struct None {};         //  None
         struct True {};         //  True
         struct False {};        //  False
+        struct While {};        //  while
+        struct For {};          //  for
+        struct In {};           //  in
+        struct Break {};        //  break
+        struct Continue {};     //  continue
     }  // namespace token_type
 
     using TokenBase
-        = std::variant<token_type::Number, token_type::Id, token_type::Char, token_type::String,
-        token_type::Class, token_type::Return, token_type::If, token_type::Else,
+        = std::variant<token_type::Number, token_type::BigNumber, token_type::Id, token_type::Char,
+        token_type::String, token_type::Class, token_type::Return, token_type::If, token_type::Else,
         token_type::Def, token_type::Newline, token_type::Print, token_type::Indent,
         token_type::Dedent, token_type::And, token_type::Or, token_type::Not,
         token_type::Eq, token_type::NotEq, token_type::LessOrEq, token_type::GreaterOrEq,
-        token_type::None, token_type::True, token_type::False, token_type::Eof>;
+        token_type::None, token_type::True, token_type::False, token_type::While,
+        token_type::For, token_type::In, token_type::Break, token_type::Continue, token_type::Eof>;
 
     struct Token : TokenBase {
         using TokenBase::TokenBase;
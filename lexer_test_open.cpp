@@ -40,6 +40,19 @@ namespace parse {
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::False{}));
         }
 
+        void TestLoopKeywords() {
+            istringstream input("while for in break continue range"s);
+            Lexer lexer(input);
+
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::While{}));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::For{}));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::In{}));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Break{}));
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Continue{}));
+            // range -  ,    
+            ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Id{ "range"s }));
+        }
+
         void TestNumbers() {
             istringstream input("42 15 -53"s);
             Lexer lexer(input);
@@ -51,6 +64,18 @@ namespace parse {
             ASSERT_EQUAL(lexer.NextToken(), Token(token_type::Number{ 53 }));
         }
 
+        void TestLargeNumbers() {
+            istringstream input("9223372036854775807"s);
+            Lexer lexer(input);
+            ASSERT_EQUAL(lexer.CurrentToken(), Token(token_type::Number{ 9223372036854775807 }));
+
+            // ,    int64_t,     
+            istringstream wide("x = 9223372036854775808"s);
+            Lexer wide_lexer(wide);
+            ASSERT_EQUAL(wide_lexer.NextToken(), Token(token_type::Char{ '=' }));
+            ASSERT_EQUAL(wide_lexer.NextToken(), Token(token_type::BigNumber{ "9223372036854775808"s }));
+        }
+
         void TestIds() {
             istringstream input("x    _42 big_number   Return Class  dEf"s);
             Lexer lexer(input);
@@ -356,7 +381,9 @@ abc#
     void RunOpenLexerTests(TestRunner& tr) {
         RUN_TEST(tr, parse::TestSimpleAssignment);
         RUN_TEST(tr, parse::TestKeywords);
+        RUN_TEST(tr, parse::TestLoopKeywords);
         RUN_TEST(tr, parse::TestNumbers);
+        RUN_TEST(tr, parse::TestLargeNumbers);
         RUN_TEST(tr, parse::TestIds);
         RUN_TEST(tr, parse::TestStrings);
         RUN_TEST(tr, parse::TestOperations);
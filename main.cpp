@@ -1,10 +1,21 @@
-﻿#include "lexer.h"
+﻿#include "interpreter.h"
+#include "lexer.h"
 #include "parse.h"
 #include "runtime.h"
 #include "statement.h"
+#include "task.h"
 #include "test_runner_p.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -18,19 +29,419 @@ namespace ast {
 namespace runtime {
     void RunObjectHolderTests(TestRunner& tr);
     void RunObjectsTests(TestRunner& tr);
+    void RunHeapTests(TestRunner& tr);
 }  // namespace runtime
+namespace interpreter {
+    void RunInterpreterTests(TestRunner& tr);
+}  // namespace interpreter
 
 void TestParseProgram(TestRunner& tr);
 
 namespace {
 
-    void RunMythonProgram(istream& input, ostream& output) {
-        parse::Lexer lexer(input);
-        auto program = ParseProgram(lexer);
+    struct ProgramOptions {
+        // Размещать объекты в куче интерпретатора со сборщиком циклов
+        bool tracing_gc = false;
+        // Освобождать память порциями не дольше заданного времени
+        std::optional<std::chrono::microseconds> reclaim_slice;
+        // Выводить в stderr статистику кучи после выполнения программы
+        bool heap_stats = false;
+        // Буферизация стандартного вывода
+        runtime::OutputOptions output;
+
+        // Файлы программ пакетного режима. Если список пуст, программа читается из стандартного ввода
+        std::vector<std::string> scripts;
+        // Число потоков пакетного режима
+        size_t jobs = 1;
+        // Выполнить единственную программу для каждой строки стандартного ввода.
+        // Строка передаётся программе в переменной input
+        bool each_line = false;
+
+        // Выполнять программы сопрограммами на одном потоке, переключаясь через заданное число шагов
+        std::int64_t slice_steps = 0;
+        // Прерывать программу, выполнившую заданное число шагов
+        std::int64_t step_limit = 0;
+
+        // Выполнить микробенчмарки вызовов методов с заданным числом итераций вместо программы
+        size_t benchmark_iterations = 0;
+
+        // Параметры разбора программ
+        interpreter::ParseOptions parse;
+        // Выводить в stderr число замен по образцам слияния узлов после разбора программы
+        bool fusion_stats = false;
+        // Выводить в stderr число встроенных вызовов методов после разбора программы
+        bool inline_stats = false;
+        // Выводить в stderr число методов на каждом уровне выполнения после выполнения программы
+        bool tier_stats = false;
+        // Выводить в stderr число скомпилированных JIT методов и возвратов в интерпретатор после выполнения программы
+        bool jit_stats = false;
+        // Если задан, методы программы переводятся в модуль C++, который записывается в этот файл,
+        // а сама программа не выполняется
+        std::optional<std::string> emit_cpp;
+    };
+
+    // Возвращает true, если программы выполняются сопрограммами
+    bool UsesTasks(const ProgramOptions& options) {
+        return options.slice_steps > 0 || options.step_limit > 0;
+    }
+
+    interpreter::RunOptions MakeRunOptions(const ProgramOptions& options) {
+        interpreter::RunOptions run_options;
+        run_options.heap.tracing = options.tracing_gc;
+        if (options.reclaim_slice) {
+            run_options.heap.incremental = true;
+            run_options.heap.slice_budget = *options.reclaim_slice;
+        }
+        return run_options;
+    }
+
+    interpreter::TaskOptions MakeTaskOptions(const ProgramOptions& options) {
+        interpreter::TaskOptions task_options;
+        task_options.heap = MakeRunOptions(options).heap;
+        if (options.slice_steps > 0) {
+            task_options.slice_steps = options.slice_steps;
+        }
+        task_options.step_limit = options.step_limit;
+        return task_options;
+    }
+
+    std::shared_ptr<const interpreter::Program> ParseMythonProgram(istream& input, const ProgramOptions& options) {
+        auto program = interpreter::Program::Parse(input, options.parse);
+        if (options.inline_stats) {
+            program->GetInlineStats().Print(cerr);
+        }
+        if (options.fusion_stats) {
+            program->GetFusionStats().Print(cerr);
+        }
+        return program;
+    }
+
+    void RunMythonProgram(istream& input, runtime::OutputSink& output, const ProgramOptions& options = {}) {
+        const auto program = ParseMythonProgram(input, options);
+        if (UsesTasks(options)) {
+            interpreter::Task task(program, output, {}, MakeTaskOptions(options));
+            while (!task.Resume()) {
+            }
+            if (task.GetError()) {
+                std::rethrow_exception(task.GetError());
+            }
+        }
+        else {
+            interpreter::RunOptions run_options = MakeRunOptions(options);
+            if (options.heap_stats) {
+                run_options.heap_stats = &cerr;
+            }
+            program->Run(output, {}, run_options);
+        }
+        if (options.tier_stats) {
+            program->GetTierStats().Print(cerr);
+        }
+        if (options.jit_stats) {
+            program->GetJitStats().Print(cerr);
+        }
+    }
+
+    void RunMythonProgram(istream& input, ostream& output, const ProgramOptions& options = {}) {
+        runtime::StreamOutput sink(output);
+        RunMythonProgram(input, sink, options);
+    }
+
+    std::shared_ptr<const interpreter::Program> ParseFile(const string& path, const ProgramOptions& options) {
+        ifstream input(path);
+        if (!input) throw std::runtime_error("Cannot open "s + path);
+        try {
+            return ParseMythonProgram(input, options);
+        }
+        catch (const std::exception& e) {
+            throw std::runtime_error(path + ": "s + e.what());
+        }
+    }
+
+    // Переводит методы программы в модуль C++ (см. native::EmitModule)
+    void EmitNativeModule(const ProgramOptions& options) {
+        if (options.scripts.size() > 1) throw std::invalid_argument("--emit-cpp requires at most one script"s);
+        ofstream output(*options.emit_cpp);
+        if (!output) throw std::runtime_error("Cannot open "s + *options.emit_cpp);
+        if (options.scripts.empty()) {
+            interpreter::Program::EmitCpp(cin, output);
+            return;
+        }
+        ifstream input(options.scripts.front());
+        if (!input) throw std::runtime_error("Cannot open "s + options.scripts.front());
+        interpreter::Program::EmitCpp(input, output);
+    }
+
+    // Выполняет задания сопрограммами на текущем потоке, чередуя их кванты
+    std::vector<interpreter::JobResult> RunTasks(const std::vector<interpreter::Job>& jobs, const ProgramOptions& options) {
+        const interpreter::TaskOptions task_options = MakeTaskOptions(options);
+        std::vector<runtime::StringOutput> outputs(jobs.size());
+        interpreter::Scheduler scheduler;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            scheduler.Spawn(jobs[i].program, outputs[i], jobs[i].variables, task_options);
+        }
+        scheduler.Run();
+
+        std::vector<interpreter::JobResult> results(jobs.size());
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            results[i].output = outputs[i].TakeString();
+            results[i].error = scheduler.GetTasks()[i]->GetError();
+        }
+        return results;
+    }
+
+    // Выполняет программы пакетного режима и выводит их результаты в порядке программ.
+    // Возвращает код завершения процесса
+    int RunBatch(const ProgramOptions& options, runtime::OutputSink& output) {
+        std::vector<interpreter::Job> jobs;
+        // Результаты программ, которые не удалось разобрать. Такие программы не выполняются,
+        // а ошибка разбора не мешает выполнить остальные
+        std::vector<interpreter::JobResult> failed;
+        if (options.each_line) {
+            if (options.scripts.size() != 1) throw std::invalid_argument("--each-line requires exactly one script"s);
+            const auto program = ParseFile(options.scripts.front(), options);
+            for (string line; getline(cin, line);) {
+                jobs.push_back({ program, { {"input"s, line} } });
+            }
+        }
+        else {
+            failed.resize(options.scripts.size());
+            for (size_t i = 0; i < options.scripts.size(); ++i) {
+                try {
+                    jobs.push_back({ ParseFile(options.scripts[i], options), {} });
+                }
+                catch (const std::exception&) {
+                    failed[i].error = std::current_exception();
+                }
+            }
+        }
+
+        auto results = UsesTasks(options) ? RunTasks(jobs, options)
+                                          : interpreter::RunJobs(jobs, options.jobs, MakeRunOptions(options));
+        if (!failed.empty()) {
+            // Результаты выполненных заданий занимают места программ, разобранных без ошибок
+            auto result = results.begin();
+            for (auto& slot : failed) {
+                if (!slot.error) slot = std::move(*result++);
+            }
+            results = std::move(failed);
+        }
+
+        int status = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            output.Write(results[i].output);
+            if (!results[i].error) continue;
+
+            output.Flush();
+            try {
+                std::rethrow_exception(results[i].error);
+            }
+            catch (const std::exception& e) {
+                cerr << "Job "sv << i + 1 << ": "sv << e.what() << endl;
+            }
+            status = 1;
+        }
+        if (options.tier_stats || options.jit_stats) {
+            // Задания --each-line выполняют одну программу
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                if (i > 0 && jobs[i].program == jobs[i - 1].program) continue;
+                if (options.tier_stats) {
+                    jobs[i].program->GetTierStats().Print(cerr);
+                }
+                if (options.jit_stats) {
+                    jobs[i].program->GetJitStats().Print(cerr);
+                }
+            }
+        }
+        return status;
+    }
+
+    /*
+     * Измеряет стоимость вызовов методов. Каждый бенчмарк выполняет тело в цикле for, а из времени
+     * итерации вычитается время итерации пустого цикла. Результат - время одной операции в наносекундах
+     */
+    void RunCallBenchmarks(size_t iterations, ostream& out) {
+        struct Benchmark {
+            string_view name;
+            string_view statement;
+        };
+        constexpr Benchmark benchmarks[] = {
+            { "loop"sv, "x = i"sv },
+            { "call, 0 arguments"sv, "x = o.zero()"sv },
+            { "call, 1 argument"sv, "x = o.one(i)"sv },
+            { "call, 3 arguments"sv, "x = o.three(i, i, i)"sv },
+            { "call, 6 arguments"sv, "x = o.six(i, i, i, i, i, i)"sv },
+            { "__add__"sv, "x = o + i"sv },
+            { "__eq__"sv, "x = o == i"sv },
+            { "new instance with __init__"sv, "x = Point(i)"sv },
+        };
+
+        std::optional<double> baseline;
+        for (const auto& benchmark : benchmarks) {
+            istringstream input(R"(
+class Calls:
+  def zero():
+    return None
+
+  def one(a):
+    return a
+
+  def three(a, b, c):
+    return c
+
+  def six(a, b, c, d, e, f):
+    return f
+
+  def __add__(other):
+    return other
+
+  def __eq__(other):
+    return True
+
+class Point:
+  def __init__(x):
+    self.x = x
+
+o = Calls()
+for i in range()"s + to_string(iterations) + "):\n  "s + string(benchmark.statement) + "\n"s);
+            const auto program = interpreter::Program::Parse(input);
+
+            runtime::StringOutput output;
+            const auto start = std::chrono::steady_clock::now();
+            program->Run(output);
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+            const double per_iteration = elapsed.count() / static_cast<double>(iterations);
+            if (!baseline) {
+                baseline = per_iteration;
+                out << benchmark.name << ": "sv << per_iteration << " ns/iteration\n"sv;
+            }
+            else {
+                out << benchmark.name << ": "sv << per_iteration - *baseline << " ns\n"sv;
+            }
+        }
+    }
+
+    // Вызывает function с приёмником стандартного вывода
+    template <typename Function>
+    void WithStandardOutput(const runtime::OutputOptions& options, Function function) {
+        // Вывод программы идёт в дескриптор стандартного вывода в обход потока cout
+        cout.flush();
+        if (options.async) {
+            runtime::AsyncFdOutput output(fileno(stdout), options);
+            function(output);
+        }
+        else {
+            runtime::FdOutput output(fileno(stdout), options);
+            function(output);
+        }
+    }
 
-        runtime::SimpleContext context{ output };
-        runtime::Closure closure;
-        program->Execute(closure, context);
+    runtime::FlushPolicy ParseFlushPolicy(string_view value) {
+        if (value == "exit"sv) return runtime::FlushPolicy::AT_EXIT;
+        if (value == "line"sv) return runtime::FlushPolicy::LINE;
+        if (value == "size"sv) return runtime::FlushPolicy::SIZE;
+        throw std::invalid_argument("Unknown flush policy: "s + string(value));
+    }
+
+    // Возвращает значение параметра вида --name=value, если arg начинается с prefix
+    std::optional<string_view> OptionValue(string_view arg, string_view prefix) {
+        if (!arg.starts_with(prefix)) return std::nullopt;
+        return arg.substr(prefix.size());
+    }
+
+    ProgramOptions ParseOptions(int argc, char* argv[]) {
+        ProgramOptions options;
+        for (int i = 1; i < argc; ++i) {
+            const string_view arg = argv[i];
+            if (arg == "--gc"sv) {
+                options.tracing_gc = true;
+            }
+            else if (arg == "--heap-stats"sv) {
+                options.heap_stats = true;
+            }
+            else if (const auto value = OptionValue(arg, "--gc-slice="sv)) {
+                options.reclaim_slice = std::chrono::microseconds{ stoll(string(*value)) };
+            }
+            else if (const auto value = OptionValue(arg, "--flush="sv)) {
+                options.output.flush_policy = ParseFlushPolicy(*value);
+            }
+            else if (arg == "--async-output"sv) {
+                options.output.async = true;
+            }
+            else if (const auto value = OptionValue(arg, "--output-buffer="sv)) {
+                options.output.buffer_size = stoull(string(*value));
+            }
+            else if (const auto value = OptionValue(arg, "--jobs="sv)) {
+                options.jobs = stoull(string(*value));
+                if (options.jobs == 0) {
+                    options.jobs = std::max(std::thread::hardware_concurrency(), 1U);
+                }
+            }
+            else if (arg == "--each-line"sv) {
+                options.each_line = true;
+            }
+            else if (const auto value = OptionValue(arg, "--slice-steps="sv)) {
+                options.slice_steps = stoll(string(*value));
+            }
+            else if (const auto value = OptionValue(arg, "--step-limit="sv)) {
+                options.step_limit = stoll(string(*value));
+            }
+            else if (arg == "--benchmark"sv) {
+                options.benchmark_iterations = 1'000'000;
+            }
+            else if (const auto value = OptionValue(arg, "--benchmark="sv)) {
+                options.benchmark_iterations = std::max<size_t>(stoull(string(*value)), 1);
+            }
+            else if (arg == "--no-fusion"sv) {
+                options.parse.fusion = false;
+            }
+            else if (arg == "--fusion-stats"sv) {
+                options.fusion_stats = true;
+            }
+            else if (arg == "--no-inline"sv) {
+                options.parse.inlining = false;
+            }
+            else if (arg == "--inline-stats"sv) {
+                options.inline_stats = true;
+            }
+            else if (arg == "--jit"sv) {
+                if (!options.parse.jit) options.parse.jit.emplace();
+            }
+            else if (const auto value = OptionValue(arg, "--jit-threshold="sv)) {
+                if (!options.parse.jit) options.parse.jit.emplace();
+                options.parse.jit->threshold = stoll(string(*value));
+            }
+            else if (arg == "--tiering"sv) {
+                if (!options.parse.tiering) options.parse.tiering.emplace();
+            }
+            else if (const auto value = OptionValue(arg, "--tier-warm="sv)) {
+                if (!options.parse.tiering) options.parse.tiering.emplace();
+                options.parse.tiering->warm = stoll(string(*value));
+            }
+            else if (const auto value = OptionValue(arg, "--tier-hot="sv)) {
+                if (!options.parse.tiering) options.parse.tiering.emplace();
+                options.parse.tiering->hot = stoll(string(*value));
+            }
+            else if (arg == "--tier-stats"sv) {
+                options.tier_stats = true;
+            }
+            else if (arg == "--jit-stats"sv) {
+                options.jit_stats = true;
+            }
+            else if (const auto value = OptionValue(arg, "--emit-cpp="sv)) {
+                options.emit_cpp = string(*value);
+            }
+            else if (const auto value = OptionValue(arg, "--native="sv)) {
+                options.parse.native_module = string(*value);
+            }
+            else if (!arg.starts_with("--"sv)) {
+                options.scripts.emplace_back(arg);
+            }
+            else {
+                throw std::invalid_argument("Unknown option: "s + argv[i]);
+            }
+        }
+        return options;
     }
 
     void TestSimplePrints() {
@@ -78,6 +489,211 @@ print x, y
         ASSERT_EQUAL(output.str(), "15 120 -13 3 15\n");
     }
 
+    void TestBigArithmetics() {
+        istringstream input(R"(
+x = 9223372036854775807
+y = x + 1
+print y, y * y, y / 3, x - y - y
+print y > x, y - 1 == x
+z = 85070591730234615865843651857942052864
+print z / y == y, -9223372036854775808
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "9223372036854775808 85070591730234615865843651857942052864 3074457345618258602 -9223372036854775809\nTrue True\nTrue -9223372036854775808\n");
+    }
+
+    void TestTailCalls() {
+        // Без хвостовых вызовов такая глубина рекурсии переполнила бы стек
+        istringstream input(R"(
+class Loop:
+  def sum(n, acc):
+    if n == 0:
+      return acc
+    return self.sum(n - 1, acc + n)
+
+  def even(n):
+    if n == 0:
+      return True
+    return self.odd(n - 1)
+
+  def odd(n):
+    if n == 0:
+      return False
+    return self.even(n - 1)
+
+class Child(Loop):
+  def start(n):
+    half = n / 2
+    return self.sum(half + half, 0)
+
+l = Child()
+print l.start(1000000), l.even(100001), l.sum(3, 0) + 1
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "500000500000 False 7\n");
+    }
+
+    void TestTailCallEvaluationOrder() {
+        // Как и при обычном вызове, аргументы вычисляются до поиска метода
+        istringstream missing(R"(
+class Caller:
+  def side():
+    print 'side'
+    return 1
+
+  def run():
+    return self.absent(self.side())
+
+c = Caller()
+c.run()
+)");
+        ostringstream missing_output;
+        ASSERT_THROWS(RunMythonProgram(missing, missing_output), runtime_error);
+        ASSERT_EQUAL(missing_output.str(), "side\n"s);
+
+        // Хвостовой вызов скомпилированного метода выполняется обычным вызовом, и аргументы
+        // вычисляются один раз
+        istringstream compiled(R"(
+class Squares:
+  def square(n):
+    return n * n
+
+  def side(n):
+    print 'side', n
+    return n
+
+  def run(n):
+    return self.square(self.side(n))
+
+s = Squares()
+print s.run(2)
+print s.run(3)
+)");
+        ProgramOptions options;
+        options.parse.jit = jit::JitOptions{ .threshold = 1 };
+        ostringstream compiled_output;
+        RunMythonProgram(compiled, compiled_output, options);
+        ASSERT_EQUAL(compiled_output.str(), "side 2\n4\nside 3\n9\n"s);
+    }
+
+    void TestLoops() {
+        istringstream input(R"(
+class Search:
+  def first_multiple(k, limit):
+    for i in range(1, limit):
+      if i / k * k == i:
+        return i
+    return None
+
+  def countdown(n):
+    while n > 0:
+      n = n - 1
+      if n > 2:
+        continue
+      return self.done(n)
+
+  def done(n):
+    return n
+
+total = 0
+for i in range(10):
+  if i == 7:
+    break
+  for j in range(i, i + 2):
+    total = total + j
+print total, i
+
+n = 0
+while True:
+  n = n + 1
+  if n < 5:
+    continue
+  break
+s = Search()
+print n, s.first_multiple(7, 100), s.first_multiple(200, 100), s.countdown(10)
+for k in range(5, 5):
+  print 'never'
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "49 7\n5 7 None 2\n");
+    }
+
+    void TestBorrowedOperandsSurviveCalls() {
+        istringstream input(R"(
+class Holder:
+  def __init__():
+    self.item = None
+
+  def drop():
+    self.item = None
+    return 1
+
+class Item:
+  def __init__(owner, value):
+    self.owner = owner
+    self.value = value
+
+  def __lt__(other):
+    self.owner.item = None
+    return self.value < other
+
+  def __eq__(other):
+    return self.value == other
+
+h = Holder()
+h.item = Item(h, 5)
+print h.item > 3, h.item
+h.item = Item(h, 7)
+print h.item.value + h.drop(), h.item
+
+class Keeper:
+  def __add__(other):
+    self.kept = other
+    return self
+
+k = Keeper()
+x = k + (2 + 3) * 4
+y = (1 + 1) * 100
+print k.kept, x.kept
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "True None\n8 None\n20 20\n");
+    }
+
+    void TestPrintOwnsArguments() {
+        istringstream input(R"(
+class Item:
+  def __str__():
+    self.owner.item = None
+    return 'item'
+
+class Holder:
+  def __init__():
+    self.item = Item()
+    self.item.owner = self
+
+h = Holder()
+print h.item, h.item
+)");
+
+        ostringstream output;
+        RunMythonProgram(input, output);
+
+        ASSERT_EQUAL(output.str(), "item None\n");
+    }
+
     void TestVariablesArePointers() {
         istringstream input(R"(
 class Counter:
@@ -111,31 +727,136 @@ print y.value
         ASSERT_EQUAL(output.str(), "2\n3\n");
     }
 
+    void TestConcurrentExecution() {
+        istringstream input(R"(
+class Counter:
+  def __init__():
+    self.value = 0
+
+  def add():
+    self.value = self.value + 1
+
+x = Counter()
+y = Counter()
+x.add()
+x.add()
+y.add()
+print x.value, y.value, 'done'
+)");
+        parse::Lexer lexer(input);
+        const auto program = ParseProgram(lexer);
+
+        // Одна разобранная программа выполняется многократно и одновременно из нескольких потоков
+        auto run = [&program] {
+            string result;
+            for (int i = 0; i < 100; ++i) {
+                runtime::Heap heap;
+                runtime::HeapScope heap_scope(heap);
+                ostringstream output;
+                runtime::SimpleContext context{ output };
+                runtime::Closure closure;
+                program->Execute(closure, context);
+                result += output.str();
+            }
+            return result;
+        };
+
+        // Каждое выполнение начинается с новых экземпляров, поэтому все 100 выводов одинаковы
+        string expected;
+        for (int i = 0; i < 100; ++i) {
+            expected += "2 1 done\n"s;
+        }
+        ASSERT_EQUAL(run(), expected);
+
+        vector<string> results(4);
+        vector<thread> threads;
+        for (auto& result : results) {
+            threads.emplace_back([&result, &run] { result = run(); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& result : results) {
+            ASSERT_EQUAL(result, expected);
+        }
+    }
+
+    void TestBatchSkipsUnparsableScripts() {
+        const auto directory = std::filesystem::temp_directory_path();
+        const string good = (directory / "mython_batch_good.my").string();
+        const string bad = (directory / "mython_batch_bad.my").string();
+        ofstream(good) << "print 'ok'\n";
+        ofstream(bad) << "print (\n";
+
+        ProgramOptions options;
+        options.scripts = { good, bad, good };
+        options.jobs = 2;
+        runtime::StringOutput output;
+        ostringstream errors;
+        auto* const cerr_buffer = cerr.rdbuf(errors.rdbuf());
+        const int status = RunBatch(options, output);
+        cerr.rdbuf(cerr_buffer);
+        std::filesystem::remove(good);
+        std::filesystem::remove(bad);
+
+        ASSERT_EQUAL(status, 1);
+        ASSERT_EQUAL(output.TakeString(), "ok\nok\n"s);
+        ASSERT(errors.str().starts_with("Job 2: "s + bad + ": "s));
+    }
+
     void TestAll() {
         TestRunner tr;
         parse::RunOpenLexerTests(tr);
         runtime::RunObjectHolderTests(tr);
         runtime::RunObjectsTests(tr);
+        runtime::RunHeapTests(tr);
         ast::RunUnitTests(tr);
+        interpreter::RunInterpreterTests(tr);
         TestParseProgram(tr);
 
         RUN_TEST(tr, TestSimplePrints);
         RUN_TEST(tr, TestAssignments);
         RUN_TEST(tr, TestArithmetics);
+        RUN_TEST(tr, TestBigArithmetics);
+        RUN_TEST(tr, TestTailCalls);
+        RUN_TEST(tr, TestTailCallEvaluationOrder);
+        RUN_TEST(tr, TestLoops);
+        RUN_TEST(tr, TestBorrowedOperandsSurviveCalls);
+        RUN_TEST(tr, TestPrintOwnsArguments);
         RUN_TEST(tr, TestVariablesArePointers);
+        RUN_TEST(tr, TestConcurrentExecution);
+        RUN_TEST(tr, TestBatchSkipsUnparsableScripts);
     }
 
 }  // namespace
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        const ProgramOptions options = ParseOptions(argc, argv);
         TestAll();
 
-        RunMythonProgram(cin, cout);
+        if (options.benchmark_iterations > 0) {
+            RunCallBenchmarks(options.benchmark_iterations, cout);
+            return 0;
+        }
+        if (options.emit_cpp) {
+            EmitNativeModule(options);
+            return 0;
+        }
+
+        int status = 0;
+        WithStandardOutput(options.output, [&](runtime::OutputSink& output) {
+            if (options.scripts.empty() && !options.each_line) {
+                RunMythonProgram(cin, output, options);
+            }
+            else {
+                status = RunBatch(options, output);
+            }
+        });
+        return status;
     }
     catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
         return 1;
     }
-    return 0;
 }
\ No newline at end of file
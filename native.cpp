@@ -0,0 +1,154 @@
+#include "native.h"
+
+#include "transpiler.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if __has_include(<dlfcn.h>)
+#define MYTHON_NATIVE_SUPPORTED
+#include <dlfcn.h>
+#endif
+
+using namespace std;
+
+//    ,   -rdynamic (. native::HOST_SYMBOL)
+extern "C" const std::uint32_t mython_host_abi_version = native::ABI_VERSION;
+
+namespace native {
+
+    namespace {
+
+        runtime::Bool true_value{ true };
+        runtime::Bool false_value{ false };
+        const runtime::ObjectHolder true_holder = runtime::ObjectHolder::Share(true_value);
+        const runtime::ObjectHolder false_holder = runtime::ObjectHolder::Share(false_value);
+
+#ifdef MYTHON_NATIVE_SUPPORTED
+
+        //     ,     
+        struct LoadedModule {
+            LoadedModule() = default;
+            LoadedModule(const LoadedModule&) = delete;
+            LoadedModule& operator=(const LoadedModule&) = delete;
+
+            ~LoadedModule() {
+                if (handle) dlclose(handle);
+            }
+
+            void* handle = nullptr;
+            vector<const runtime::Class*> classes;
+        };
+
+#endif
+
+    }  // namespace
+
+    void ThrowUndefined() {
+        throw runtime_error("Not found variable!"s);
+    }
+
+    void SetField(const runtime::ObjectHolder& object, const string& name, runtime::ObjectHolder value) {
+        auto* instance = object.TryAs<runtime::ClassInstance>();
+        if (!instance) throw runtime_error("Only class instances have fields!"s);
+        instance->Fields().insert_or_assign(name, std::move(value));
+        runtime::Heap::WriteBarrier(*instance);
+    }
+
+    const runtime::ObjectHolder& MakeBool(bool value) noexcept {
+        return value ? true_holder : false_holder;
+    }
+
+    int64_t RangeBound(const runtime::ObjectHolder& value) {
+        if (const auto* number = value.TryAs<runtime::Number>()) return number->GetValue();
+        throw runtime_error("range() arguments must be integers"s);
+    }
+
+    bool IsSupported() noexcept {
+#ifdef MYTHON_NATIVE_SUPPORTED
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    const runtime::Method& FindTailCallMethod(const runtime::ObjectHolder& object, const string& name,
+                                              size_t argument_count) {
+        const auto* instance = object.TryAs<runtime::ClassInstance>();
+        const runtime::Method* method = instance ? instance->FindMethod(name, argument_count) : nullptr;
+        if (!method) throw runtime_error("Method not found"s);
+        return *method;
+    }
+
+    NativeMethod::NativeMethod(Function function, Binding binding, shared_ptr<const void> module,
+                               unique_ptr<runtime::Executable> body)
+        : function_(function)
+        , binding_(binding)
+        , module_(std::move(module))
+        , body_(std::move(body)) {
+    }
+
+    runtime::ObjectHolder NativeMethod::Execute(runtime::Closure& closure, runtime::Context& context) {
+        return body_->Execute(closure, context);
+    }
+
+    bool NativeMethod::TryCall(runtime::ClassInstance& self, span<const runtime::ObjectHolder> args,
+                               runtime::Context& context, runtime::ObjectHolder& result) {
+        result = function_(self, args, context, binding_);
+        return true;
+    }
+
+    vector<runtime::Class*> CheckModule(const Module& module, runtime::Executable& root, const string& path) {
+        if (module.abi_version != ABI_VERSION) {
+            throw runtime_error("Native module "s + path + " was built for another interpreter version"s);
+        }
+        vector<runtime::Class*> classes = ProgramClasses(root);
+        bool matches = module.class_count == classes.size() && module.fingerprint == ModuleFingerprint(root);
+        for (size_t i = 0; matches && i < module.method_count; ++i) {
+            const ModuleMethod& entry = module.methods[i];
+            matches = entry.class_index < classes.size() && entry.method_index < classes[entry.class_index]->methods_.size()
+                && classes[entry.class_index]->methods_[entry.method_index].name == entry.name;
+        }
+        if (!matches) {
+            throw runtime_error("Native module "s + path + " was generated from another program"s);
+        }
+        return classes;
+    }
+
+    size_t LoadModule(const string& path, unique_ptr<runtime::Executable>& root) {
+#ifdef MYTHON_NATIVE_SUPPORTED
+        if (!root) return 0;
+        //     runtime::  ast:: .   
+        // dlopen       
+        if (!dlsym(RTLD_DEFAULT, HOST_SYMBOL)) {
+            throw runtime_error("Cannot load native module "s + path
+                                + ": the interpreter must be linked with exported symbols (-rdynamic)"s);
+        }
+
+        auto module = make_shared<LoadedModule>();
+        module->handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!module->handle) {
+            throw runtime_error("Cannot load native module "s + path + ": "s + dlerror());
+        }
+        const auto* description = static_cast<const Module*>(dlsym(module->handle, MODULE_SYMBOL));
+        if (!description) {
+            throw runtime_error(path + " is not a Mython native module"s);
+        }
+        const vector<runtime::Class*> classes = CheckModule(*description, *root, path);
+
+        module->classes.assign(classes.begin(), classes.end());
+        for (size_t i = 0; i < description->method_count; ++i) {
+            const ModuleMethod& entry = description->methods[i];
+            runtime::Method& method = classes[entry.class_index]->methods_[entry.method_index];
+            method.body = make_unique<NativeMethod>(entry.function, Binding{ module->classes.data(), &method }, module,
+                                                    std::move(method.body));
+        }
+        return description->method_count;
+#else
+        static_cast<void>(root);
+        throw runtime_error("Cannot load native module "s + path + ": not supported on this platform"s);
+#endif
+    }
+
+}  // namespace native
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "runtime.h"
+#include "statement.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace native {
+
+    /*
+     *      C++,      Mython
+     * (. transpiler.h).          
+     *    .       runtime::  ast::
+     *  ,         ,
+     *        (-rdynamic).   LoadModule
+     *   
+     */
+
+    //  .      ,  
+    inline constexpr std::uint32_t ABI_VERSION = 1;
+
+    // ,       (. Module)
+    inline constexpr const char* MODULE_SYMBOL = "mython_module";
+
+    // ,     ABI_VERSION.      dlsym,
+    //            
+    inline constexpr const char* HOST_SYMBOL = "mython_host_abi_version";
+
+    //  true,        ( dlopen)
+    [[nodiscard]] bool IsSupported() noexcept;
+
+    //     ,    
+    struct Binding {
+        //      
+        const runtime::Class* const* classes = nullptr;
+        // ,    
+        const runtime::Method* method = nullptr;
+    };
+
+    //    
+    using Function = runtime::ObjectHolder (*)(runtime::ClassInstance& self, std::span<const runtime::ObjectHolder> args,
+                                               runtime::Context& context, const Binding& binding);
+
+    struct ModuleMethod {
+        //          
+        std::size_t class_index;
+        std::size_t method_index;
+        //  .   
+        const char* name;
+        Function function;
+    };
+
+    struct Module {
+        std::uint32_t abi_version;
+        //  ,     (. ModuleFingerprint)
+        std::uint64_t fingerprint;
+        std::size_t class_count;
+        const ModuleMethod* methods;
+        std::size_t method_count;
+    };
+
+    [[noreturn]] void ThrowUndefined();
+
+    //   .  ,     ,
+    //    ,   
+    class Variable {
+    public:
+        Variable() = default;
+
+        explicit Variable(runtime::ObjectHolder value) noexcept
+            : value_(std::move(value))
+            , defined_(true) {
+        }
+
+        [[nodiscard]] const runtime::ObjectHolder& Get() const {
+            if (!defined_) ThrowUndefined();
+            return value_;
+        }
+
+        void Set(runtime::ObjectHolder value) noexcept {
+            value_ = std::move(value);
+            defined_ = true;
+        }
+
+        //   . ,     ,   
+        void SetNumber(std::int64_t value) {
+            if (auto* number = value_.IsUnique() ? value_.TryAs<runtime::Number>() : nullptr) {
+                number->SetValue(value);
+            }
+            else {
+                Set(runtime::ObjectHolder::Own(runtime::Number{ value }));
+            }
+        }
+
+        void Reset() noexcept {
+            value_ = {};
+            defined_ = false;
+        }
+
+    private:
+        runtime::ObjectHolder value_;
+        bool defined_ = false;
+    };
+
+    //   name  object. ,    , 
+    //  :     a.b.c (. ast::VariableValue)
+    inline const runtime::ObjectHolder& Field(const runtime::ObjectHolder& object, const std::string& name) {
+        auto* instance = object.TryAs<runtime::ClassInstance>();
+        if (!instance) return object;
+        const auto it = instance->Fields().find(name);
+        if (it == instance->Fields().end()) ThrowUndefined();
+        return it->second;
+    }
+
+    void SetField(const runtime::ObjectHolder& object, const std::string& name, runtime::ObjectHolder value);
+
+    //  True  False
+    [[nodiscard]] const runtime::ObjectHolder& MakeBool(bool value) noexcept;
+
+    //   range().    Number
+    std::int64_t RangeBound(const runtime::ObjectHolder& value);
+
+    //      Number.     ast
+    inline runtime::ObjectHolder Add(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                                     runtime::Context& context) {
+        const auto* l = lhs.TryAs<runtime::Number>();
+        const auto* r = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; l && r && !runtime::AddOverflow(l->GetValue(), r->GetValue(), result)) {
+            return runtime::ObjectHolder::Own(runtime::Number{ result });
+        }
+        return ast::Add::Apply(lhs, rhs, context);
+    }
+
+    inline runtime::ObjectHolder Sub(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                                     runtime::Context& context) {
+        const auto* l = lhs.TryAs<runtime::Number>();
+        const auto* r = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; l && r && !runtime::SubOverflow(l->GetValue(), r->GetValue(), result)) {
+            return runtime::ObjectHolder::Own(runtime::Number{ result });
+        }
+        return ast::Sub::Apply(lhs, rhs, context);
+    }
+
+    inline runtime::ObjectHolder Mult(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                                      runtime::Context& context) {
+        const auto* l = lhs.TryAs<runtime::Number>();
+        const auto* r = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; l && r && !runtime::MulOverflow(l->GetValue(), r->GetValue(), result)) {
+            return runtime::ObjectHolder::Own(runtime::Number{ result });
+        }
+        return ast::Mult::Apply(lhs, rhs, context);
+    }
+
+    inline runtime::ObjectHolder Div(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+                                     runtime::Context& context) {
+        const auto* l = lhs.TryAs<runtime::Number>();
+        const auto* r = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; l && r && r->GetValue() != 0 && !runtime::DivOverflow(l->GetValue(), r->GetValue(), result)) {
+            return runtime::ObjectHolder::Own(runtime::Number{ result });
+        }
+        return ast::Div::Apply(lhs, rhs, context);
+    }
+
+    //      Number.     runtime
+    template <typename NumberComparator, bool (*Compare)(const runtime::ObjectHolder&, const runtime::ObjectHolder&, runtime::Context&)>
+    bool CompareValues(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs, runtime::Context& context) {
+        const auto* l = lhs.TryAs<runtime::Number>();
+        const auto* r = rhs.TryAs<runtime::Number>();
+        if (l && r) return NumberComparator{}(l->GetValue(), r->GetValue());
+        return Compare(lhs, rhs, context);
+    }
+
+    inline constexpr auto Equal = CompareValues<std::equal_to<>, runtime::Equal>;
+    inline constexpr auto NotEqual = CompareValues<std::not_equal_to<>, runtime::NotEqual>;
+    inline constexpr auto Less = CompareValues<std::less<>, runtime::Less>;
+    inline constexpr auto Greater = CompareValues<std::greater<>, runtime::Greater>;
+    inline constexpr auto LessOrEqual = CompareValues<std::less_equal<>, runtime::LessOrEqual>;
+    inline constexpr auto GreaterOrEqual = CompareValues<std::greater_equal<>, runtime::GreaterOrEqual>;
+
+    //   name  object (. ast::MethodCall)
+    inline runtime::ObjectHolder Call(const runtime::ObjectHolder& object, const std::string& name,
+                                      std::initializer_list<runtime::ObjectHolder> args, runtime::Context& context) {
+        return ast::MethodCall::Call(object, name, std::span(args.begin(), args.size()), context);
+    }
+
+    //   name  object,    (. ast::TailCall).
+    //   ,    ,   
+    const runtime::Method& FindTailCallMethod(const runtime::ObjectHolder& object, const std::string& name,
+                                              std::size_t argument_count);
+
+    //  ,  FindTailCallMethod
+    inline runtime::ObjectHolder Invoke(const runtime::ObjectHolder& object, const runtime::Method& method,
+                                        std::initializer_list<runtime::ObjectHolder> args, runtime::Context& context) {
+        return object.TryAs<runtime::ClassInstance>()->CallMethod(method, std::span(args.begin(), args.size()), context);
+    }
+
+    //    cls (. ast::NewInstance)
+    inline runtime::ObjectHolder New(const runtime::Class& cls, std::initializer_list<runtime::ObjectHolder> args,
+                                     runtime::Context& context) {
+        return ast::NewInstance::Create(cls, std::span(args.begin(), args.size()), context);
+    }
+
+    /*
+     *  ,    .   :  ,
+     *       (Execute),    ClassInstance::CallMethod
+     */
+    class NativeMethod : public runtime::Executable {
+    public:
+        NativeMethod(Function function, Binding binding, std::shared_ptr<const void> module,
+                     std::unique_ptr<runtime::Executable> body);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool TryCall(runtime::ClassInstance& self, std::span<const runtime::ObjectHolder> args,
+                     runtime::Context& context, runtime::ObjectHolder& result) override;
+
+    private:
+        Function function_;
+        Binding binding_;
+        //       
+        std::shared_ptr<const void> module_;
+        std::unique_ptr<runtime::Executable> body_;
+    };
+
+    /*
+     * ,   module        root: 
+     * , ,     .   ,  
+     *   .   runtime_error,     path
+     */
+    std::vector<runtime::Class*> CheckModule(const Module& module, runtime::Executable& root, const std::string& path);
+
+    /*
+     *      path      
+     *  root.         (. CheckModule): ,
+     *     ,  runtime_error.     
+     */
+    size_t LoadModule(const std::string& path, std::unique_ptr<runtime::Executable>& root);
+
+}  // namespace native
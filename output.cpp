@@ -0,0 +1,214 @@
+#include "output.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace runtime {
+
+    namespace {
+
+        //  first  second   fd 
+        void WriteAll(int fd, string_view first, string_view second = {}) {
+            while (!first.empty() || !second.empty()) {
+#ifdef _WIN32
+                string_view& part = first.empty() ? second : first;
+                const auto written = _write(fd, part.data(), static_cast<unsigned>(part.size()));
+                if (written < 0) throw system_error(errno, generic_category(), "write");
+                part.remove_prefix(static_cast<size_t>(written));
+#else
+                iovec parts[2];
+                int count = 0;
+                for (const string_view part : { first, second }) {
+                    if (part.empty()) continue;
+                    parts[count].iov_base = const_cast<char*>(part.data());
+                    parts[count].iov_len = part.size();
+                    ++count;
+                }
+
+                ssize_t written = ::writev(fd, parts, count);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw system_error(errno, generic_category(), "writev");
+                }
+
+                //  :     
+                const size_t from_first = min(static_cast<size_t>(written), first.size());
+                first.remove_prefix(from_first);
+                second.remove_prefix(static_cast<size_t>(written) - from_first);
+#endif
+            }
+        }
+
+        //    -     size
+        size_t RingCapacity(size_t size) {
+            size_t capacity = 4096;
+            while (capacity < size) capacity *= 2;
+            return capacity;
+        }
+
+    }  // namespace
+
+    FdOutput::FdOutput(int fd, OutputOptions options)
+        : fd_(fd)
+        , options_(options) {
+        buffer_.reserve(options_.buffer_size);
+    }
+
+    FdOutput::~FdOutput() {
+        try {
+            Flush();
+        }
+        catch (const system_error&) {
+        }
+    }
+
+    void FdOutput::Write(string_view data) {
+        switch (options_.flush_policy) {
+        case FlushPolicy::AT_EXIT:
+            buffer_.append(data);
+            break;
+        case FlushPolicy::LINE:
+            buffer_.append(data);
+            if (data.find('\n') != string_view::npos) Flush();
+            break;
+        case FlushPolicy::SIZE:
+            if (buffer_.size() + data.size() <= options_.buffer_size) {
+                buffer_.append(data);
+            }
+            else if (data.size() < options_.buffer_size) {
+                Flush();
+                buffer_.append(data);
+            }
+            else {
+                //      ,     
+                WriteAll(fd_, buffer_, data);
+                buffer_.clear();
+            }
+            break;
+        }
+    }
+
+    void FdOutput::Flush() {
+        if (buffer_.empty()) return;
+        WriteAll(fd_, buffer_);
+        buffer_.clear();
+    }
+
+    AsyncFdOutput::AsyncFdOutput(int fd, OutputOptions options)
+        : fd_(fd)
+        , options_(options)
+        , capacity_(RingCapacity(options.buffer_size))
+        , ring_(make_unique<char[]>(capacity_))
+        , writer_([this] { RunWriter(); }) {
+    }
+
+    AsyncFdOutput::~AsyncFdOutput() {
+        //   ,   
+        stopping_.store(true);
+        WakeWriter();
+        writer_.join();
+    }
+
+    void AsyncFdOutput::Write(string_view data) {
+        ThrowIfFailed();
+        const bool flush = options_.flush_policy == FlushPolicy::LINE && data.find('\n') != string_view::npos;
+
+        size_t head = head_.load(memory_order_relaxed);
+        while (!data.empty()) {
+            const size_t tail = tail_.load(memory_order_acquire);
+            const size_t free = capacity_ - (head - tail);
+            if (free == 0) {
+                WaitForWriter(tail);
+                ThrowIfFailed();
+                continue;
+            }
+
+            const size_t index = head & (capacity_ - 1);
+            const size_t count = min({ free, data.size(), capacity_ - index });
+            memcpy(ring_.get() + index, data.data(), count);
+            data.remove_prefix(count);
+            head += count;
+            head_.store(head);
+            WakeWriter();
+        }
+
+        if (flush) Flush();
+    }
+
+    void AsyncFdOutput::Flush() {
+        const size_t head = head_.load(memory_order_relaxed);
+        for (size_t tail = tail_.load(); tail != head; tail = tail_.load()) {
+            WaitForWriter(tail);
+        }
+        ThrowIfFailed();
+    }
+
+    void AsyncFdOutput::RunWriter() {
+        size_t tail = tail_.load(memory_order_relaxed);
+        for (;;) {
+            const size_t head = head_.load(memory_order_acquire);
+            if (head == tail) {
+                if (stopping_.load()) return;
+                //     ,     
+                writer_sleeping_.store(true);
+                if (head_.load() == tail && !stopping_.load()) writer_sleeping_.wait(true);
+                writer_sleeping_.store(false);
+                continue;
+            }
+
+            //    ,     
+            if (!failed_.load(memory_order_relaxed)) {
+                const size_t index = tail & (capacity_ - 1);
+                const size_t count = head - tail;
+                const size_t first = min(count, capacity_ - index);
+                try {
+                    WriteAll(fd_, { ring_.get() + index, first }, { ring_.get(), count - first });
+                }
+                catch (...) {
+                    error_ = current_exception();
+                    failed_.store(true, memory_order_release);
+                }
+            }
+
+            tail = head;
+            tail_.store(tail);
+            WakeProducer();
+        }
+    }
+
+    void AsyncFdOutput::WakeWriter() {
+        if (writer_sleeping_.load()) {
+            writer_sleeping_.store(false);
+            writer_sleeping_.notify_one();
+        }
+    }
+
+    void AsyncFdOutput::WakeProducer() {
+        if (producer_sleeping_.load()) {
+            producer_sleeping_.store(false);
+            producer_sleeping_.notify_one();
+        }
+    }
+
+    void AsyncFdOutput::WaitForWriter(size_t tail) {
+        producer_sleeping_.store(true);
+        if (tail_.load() == tail) producer_sleeping_.wait(true);
+        producer_sleeping_.store(false);
+    }
+
+    void AsyncFdOutput::ThrowIfFailed() const {
+        if (failed_.load(memory_order_acquire)) rethrow_exception(error_);
+    }
+
+}  // namespace runtime
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace runtime {
+
+    //    print
+    class OutputSink {
+    public:
+        //  data   
+        virtual void Write(std::string_view data) = 0;
+        //    
+        virtual void Flush() = 0;
+
+    protected:
+        ~OutputSink() = default;
+    };
+
+    //     std::ostream
+    class StreamOutput final : public OutputSink {
+    public:
+        explicit StreamOutput(std::ostream& output) noexcept
+            : output_(output) {
+        }
+
+        void Write(std::string_view data) override {
+            output_.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        void Flush() override {
+            output_.flush();
+        }
+
+    private:
+        std::ostream& output_;
+    };
+
+    //    
+    class StringOutput final : public OutputSink {
+    public:
+        void Write(std::string_view data) override {
+            output_.append(data);
+        }
+
+        void Flush() override {
+        }
+
+        [[nodiscard]] const std::string& GetString() const noexcept {
+            return output_;
+        }
+
+        //   ,   
+        [[nodiscard]] std::string TakeString() noexcept {
+            return std::exchange(output_, {});
+        }
+
+    private:
+        std::string output_;
+    };
+
+    // ,       
+    enum class FlushPolicy {
+        //     Flush    
+        AT_EXIT,
+        //    
+        LINE,
+        //   
+        SIZE,
+    };
+
+    struct OutputOptions {
+        FlushPolicy flush_policy = FlushPolicy::SIZE;
+        //     SIZE     
+        size_t buffer_size = 64 * 1024;
+        //         (. AsyncFdOutput)
+        bool async = false;
+    };
+
+    /*
+     *            
+     *  write. ,    ,     
+     *   writev,   .
+     *       std::system_error
+     */
+    class FdOutput final : public OutputSink {
+    public:
+        explicit FdOutput(int fd, OutputOptions options = {});
+        //   .     
+        ~FdOutput();
+
+        FdOutput(const FdOutput&) = delete;
+        FdOutput& operator=(const FdOutput&) = delete;
+
+        void Write(std::string_view data) override;
+        void Flush() override;
+
+    private:
+        int fd_;
+        OutputOptions options_;
+        std::string buffer_;
+    };
+
+    /*
+     *         ,   
+     *    . Write       
+     * ( ,  ),          .
+     *   , Write ,     .
+     *
+     * Flush   ,      .   
+     *    Write  Flush   std::system_error.
+     *  Write  Flush     
+     */
+    class AsyncFdOutput final : public OutputSink {
+    public:
+        explicit AsyncFdOutput(int fd, OutputOptions options = {});
+        ~AsyncFdOutput();
+
+        AsyncFdOutput(const AsyncFdOutput&) = delete;
+        AsyncFdOutput& operator=(const AsyncFdOutput&) = delete;
+
+        void Write(std::string_view data) override;
+        void Flush() override;
+
+    private:
+        void RunWriter();
+        void WakeWriter();
+        void WakeProducer();
+        // ,         tail
+        void WaitForWriter(size_t tail);
+        void ThrowIfFailed() const;
+
+        int fd_;
+        OutputOptions options_;
+        size_t capacity_;
+        std::unique_ptr<char[]> ring_;
+
+        //      ,    -    capacity_
+        alignas(64) std::atomic<size_t> head_{ 0 };
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+        std::atomic<bool> writer_sleeping_{ false };
+        std::atomic<bool> producer_sleeping_{ false };
+        std::atomic<bool> stopping_{ false };
+        std::atomic<bool> failed_{ false };
+        std::exception_ptr error_;
+
+        std::thread writer_;
+    };
+
+    //  ,     OutputSink.   Object::Print
+    class SinkStream final : public std::ostream {
+    public:
+        explicit SinkStream(OutputSink& sink)
+            : std::ostream(&buf_)
+            , buf_(sink) {
+        }
+
+    private:
+        class Buf final : public std::streambuf {
+        public:
+            explicit Buf(OutputSink& sink) noexcept
+                : sink_(sink) {
+            }
+
+        protected:
+            int_type overflow(int_type ch) override {
+                if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                    const char c = traits_type::to_char_type(ch);
+                    sink_.Write(std::string_view(&c, 1));
+                }
+                return traits_type::not_eof(ch);
+            }
+
+            std::streamsize xsputn(const char* data, std::streamsize size) override {
+                sink_.Write(std::string_view(data, static_cast<size_t>(size)));
+                return size;
+            }
+
+            int sync() override {
+                sink_.Flush();
+                return 0;
+            }
+
+        private:
+            OutputSink& sink_;
+        };
+
+        Buf buf_;
+    };
+
+}  // namespace runtime
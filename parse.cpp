@@ -76,7 +76,12 @@ namespace {
                 lexer_.ExpectNext<TokenType::Char>(':');
                 lexer_.NextToken();
 
+                // Loops enclosing the class definition do not extend into its methods
+                const bool outer_in_method = std::exchange(in_method_, true);
+                const size_t outer_loop_depth = std::exchange(loop_depth_, 0);
                 m.body = std::make_unique<ast::MethodBody>(ParseSuite());  // NOLINT
+                in_method_ = outer_in_method;
+                loop_depth_ = outer_loop_depth;
 
                 result.push_back(std::move(m));
             }
@@ -120,6 +125,8 @@ namespace {
             if (!inserted) {
                 throw ParseError("Class "s + class_name + " already exists"s);
             }
+            // Every execution of the program references the class, possibly from several threads
+            it->second->MakeThreadShared();
 
             return make_unique<ast::ClassDefinition>(it->second);
         }
@@ -229,12 +236,17 @@ namespace {
                 return make_unique<ast::Mult>(ParseMult(), make_unique<ast::NumericConst>(-1));
             }
             if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::Number>()) {
-                int result = num->value;
+                const auto result = num->value;
                 lexer_.NextToken();
                 return make_unique<ast::NumericConst>(result);
             }
+            if (const auto* num = lexer_.CurrentToken().TryAs<TokenType::BigNumber>()) {
+                auto result = runtime::BigInteger::FromString(num->value);
+                lexer_.NextToken();
+                return make_unique<ast::BigNumericConst>(std::move(result));
+            }
             if (const auto* str = lexer_.CurrentToken().TryAs<TokenType::String>()) {
-                string result = str->value;
+                auto result = runtime::String::Intern(str->value);
                 lexer_.NextToken();
                 return make_unique<ast::StringConst>(std::move(result));
             }
@@ -398,9 +410,69 @@ namespace {
             return result;
         }
 
+        // While -> while Test ':' Suite
+        unique_ptr<ast::Statement> ParseWhile()  // NOLINT
+        {
+            lexer_.Expect<TokenType::While>();
+            lexer_.NextToken();
+
+            auto condition = ParseTest();
+
+            lexer_.Expect<TokenType::Char>(':');
+            lexer_.NextToken();
+
+            return make_unique<ast::While>(std::move(condition), ParseLoopBody());
+        }
+
+        // For -> for Id in range '(' Test [',' Test] ')' ':' Suite
+        unique_ptr<ast::Statement> ParseFor()  // NOLINT
+        {
+            lexer_.Expect<TokenType::For>();
+            string var = lexer_.ExpectNext<TokenType::Id>().value;
+            lexer_.ExpectNext<TokenType::In>();
+            if (lexer_.ExpectNext<TokenType::Id>().value != "range"sv) {
+                throw ParseError("Only range() can be iterated over"s);
+            }
+            lexer_.ExpectNext<TokenType::Char>('(');
+            lexer_.NextToken();
+
+            vector<unique_ptr<ast::Statement>> args;
+            if (lexer_.CurrentToken() != ')') {
+                args = ParseTestList();
+            }
+            lexer_.Expect<TokenType::Char>(')');
+            lexer_.ExpectNext<TokenType::Char>(':');
+            lexer_.NextToken();
+
+            unique_ptr<ast::Statement> begin;
+            unique_ptr<ast::Statement> end;
+            if (args.size() == 1) {
+                begin = make_unique<ast::NumericConst>(0);
+                end = std::move(args.front());
+            }
+            else if (args.size() == 2) {
+                begin = std::move(args.front());
+                end = std::move(args.back());
+            }
+            else {
+                throw ParseError("range() takes one or two arguments"s);
+            }
+
+            return make_unique<ast::ForRange>(std::move(var), std::move(begin), std::move(end), ParseLoopBody());
+        }
+
+        unique_ptr<ast::Statement> ParseLoopBody() {
+            ++loop_depth_;
+            auto body = ParseSuite();
+            --loop_depth_;
+            return body;
+        }
+
         // Statement -> SimpleStatement Newline
         //           | class ClassDefinition
         //           | if Condition
+        //           | while While
+        //           | for For
         unique_ptr<ast::Statement> ParseStatement()  // NOLINT
         {
             const auto& tok = lexer_.CurrentToken();
@@ -412,6 +484,12 @@ namespace {
             if (tok.Is<TokenType::If>()) {
                 return ParseCondition();
             }
+            if (tok.Is<TokenType::While>()) {
+                return ParseWhile();
+            }
+            if (tok.Is<TokenType::For>()) {
+                return ParseFor();
+            }
             auto result = ParseSimpleStatement();
             lexer_.Expect<TokenType::Newline>();
             lexer_.NextToken();
@@ -420,13 +498,32 @@ namespace {
 
         // StatementBody -> return Expression
         //               | print ExpressionList
+        //               | break
+        //               | continue
         //               | AssignmentOrCall
         unique_ptr<ast::Statement> ParseSimpleStatement() {
             const auto& tok = lexer_.CurrentToken();
 
+            if (tok.Is<TokenType::Break>() || tok.Is<TokenType::Continue>()) {
+                if (loop_depth_ == 0) {
+                    throw ParseError("'break' and 'continue' are allowed only inside a loop"s);
+                }
+                const bool is_break = tok.Is<TokenType::Break>();
+                lexer_.NextToken();
+                if (is_break) {
+                    return make_unique<ast::Break>();
+                }
+                return make_unique<ast::Continue>();
+            }
             if (tok.Is<TokenType::Return>()) {
                 lexer_.NextToken();
-                return make_unique<ast::Return>(ParseTest());
+                auto value = ParseTest();
+                // return self.method(...) inside a method reuses the caller's frame
+                if (auto* call = dynamic_cast<ast::MethodCall*>(value.get()); in_method_ && call && call->IsSelfCall()) {
+                    value.release();
+                    return make_unique<ast::TailCall>(unique_ptr<ast::MethodCall>(call));
+                }
+                return make_unique<ast::Return>(std::move(value));
             }
             if (tok.Is<TokenType::Print>()) {
                 lexer_.NextToken();
@@ -441,10 +538,15 @@ namespace {
 
         parse::Lexer& lexer_;
         runtime::Closure declared_classes_;
+        bool in_method_ = false;
+        // Number of loops enclosing the statement being parsed
+        size_t loop_depth_ = 0;
     };
 
 }  // namespace
 
 unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer) {
+    // The program outlives the heaps of the threads running it, so its objects live outside of them
+    runtime::HeapScope no_heap(nullptr);
     return Parser{ lexer }.ParseProgram();
 }
\ No newline at end of file
@@ -15,4 +15,7 @@ struct ParseError : std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+// The parsed program is immutable: every execution keeps its state in the Closure, Context
+// and heap it is given. It can be executed any number of times, including from several
+// threads at once.
 std::unique_ptr<runtime::Executable> ParseProgram(parse::Lexer& lexer);
\ No newline at end of file
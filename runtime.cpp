@@ -1,6 +1,8 @@
 #include "runtime.h"
 
 #include <cassert>
+#include <charconv>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <algorithm>
@@ -9,17 +11,28 @@ using namespace std;
 
 namespace runtime {
 
-    ObjectHolder::ObjectHolder(std::shared_ptr<Object> data)
-        : data_(std::move(data)) {
+    namespace {
+        const string STR_METHOD = "__str__"s;
+        const string EQ_METHOD = "__eq__"s;
+        const string LT_METHOD = "__lt__"s;
+    }  // namespace
+
+    ObjectHolder::ObjectHolder(Object* data) noexcept
+        : data_(reinterpret_cast<std::uintptr_t>(data)) {
+        if (data) data->AddRef();
     }
 
     void ObjectHolder::AssertIsValid() const {
-        assert(data_ != nullptr);
+        assert(data_ != 0);
     }
 
     ObjectHolder ObjectHolder::Share(Object& object) {
-        //   shared_ptr ( deleter   )
-        return ObjectHolder(std::shared_ptr<Object>(&object, [](auto* /*p*/) { /* do nothing */ }));
+        if (object.IsOwned()) return ObjectHolder(&object);
+
+        //  ,    Own,   ,  ObjectHolder   
+        ObjectHolder result;
+        result.data_ = reinterpret_cast<std::uintptr_t>(&object) | BORROWED;
+        return result;
     }
 
     ObjectHolder ObjectHolder::None() {
@@ -36,12 +49,49 @@ namespace runtime {
         return Get();
     }
 
-    Object* ObjectHolder::Get() const {
-        return data_.get();
+    String String::Intern(std::string_view value) {
+        //      :     
+        static std::mutex table_mutex;
+        static std::unordered_map<std::string_view, std::unique_ptr<Buffer>> table;
+
+        Buffer* buffer = nullptr;
+        {
+            std::lock_guard guard(table_mutex);
+            auto it = table.find(value);
+            if (it == table.end()) {
+                auto inserted = std::make_unique<Buffer>(Buffer{ std::string(value), true, true });
+                it = table.emplace(std::string_view(inserted->data), std::move(inserted)).first;
+            }
+            buffer = it->second.get();
+        }
+
+        String result(BufferRef(buffer), value.size());
+        result.interned_ = true;
+        result.hash_ = std::hash<std::string_view>{}(value);
+        result.hash_known_ = true;
+        return result;
     }
 
-    ObjectHolder::operator bool() const {
-        return Get() != nullptr;
+    bool operator==(const String& lhs, const String& rhs) noexcept {
+        if (lhs.buffer_.Get() == rhs.buffer_.Get() && lhs.size_ == rhs.size_) return true;
+        if (lhs.interned_ && rhs.interned_) return false;
+        if (lhs.size_ != rhs.size_) return false;
+        if (lhs.hash_known_ && rhs.hash_known_ && lhs.hash_ != rhs.hash_) return false;
+        return lhs.GetView() == rhs.GetView();
+    }
+
+    String String::Concat(const String& lhs, const String& rhs) {
+        const BufferRef& buffer = lhs.buffer_;
+        const std::string_view tail = rhs.GetView();
+        if (!buffer->frozen && buffer->data.size() == lhs.size_ && buffer.Get() != rhs.buffer_.Get()) {
+            buffer->data.append(tail);
+            return String(buffer, lhs.size_ + tail.size());
+        }
+
+        BufferRef result(new Buffer{ {}, false });
+        result->data.reserve(lhs.size_ + tail.size());
+        result->data.append(lhs.GetView()).append(tail);
+        return String(std::move(result), lhs.size_ + tail.size());
     }
 
     bool IsTrue(const ObjectHolder& object) {
@@ -50,8 +100,9 @@ namespace runtime {
         auto ptr_bool = object.TryAs<Bool>();
         auto ptr_bool_vo = object.TryAs<ValueObject<bool>>();
 
-        if (ptr_number) return ptr_number->GetValue();
-        else if (ptr_string) return !ptr_string->GetValue().empty();
+        if (ptr_number) return ptr_number->GetValue() != 0;
+        else if (object.TryAs<BigNumber>()) return true;
+        else if (ptr_string) return !ptr_string->GetView().empty();
         else if (ptr_bool) return ptr_bool->GetValue();
         else if (ptr_bool_vo) return ptr_bool_vo->GetValue();
 
@@ -59,17 +110,21 @@ namespace runtime {
     }
 
     void ClassInstance::Print(std::ostream& os, Context& context) {
-        if (class_.GetMethod("__str__")) {
-            this->Call("__str__", {}, context)->Print(os, context);
+        if (const Method* method = FindMethod(STR_METHOD, 0)) {
+            CallMethod(*method, {}, context)->Print(os, context);
             return;
         }
         os << this;
     }
 
     bool ClassInstance::HasMethod(const std::string& method, size_t argument_count) const {
+        return FindMethod(method, argument_count) != nullptr;
+    }
+
+    const Method* ClassInstance::FindMethod(const std::string& method, size_t argument_count) const {
         const Method* the_method = class_.GetMethod(method);
-        if (the_method) return the_method->formal_params.size() == argument_count;
-        return false;
+        if (the_method && the_method->formal_params.size() == argument_count) return the_method;
+        return nullptr;
     }
 
     Closure& ClassInstance::Fields() {
@@ -89,17 +144,78 @@ namespace runtime {
         const std::vector<ObjectHolder>& actual_args,
         Context& context) 
     {
-        if (!this->HasMethod(method, actual_args.size())) throw std::runtime_error("Method not found"s);
+        const Method* ptr_method = FindMethod(method, actual_args.size());
+        if (!ptr_method) throw std::runtime_error("Method not found"s);
+        return CallMethod(*ptr_method, actual_args, context);
+    }
+
+    ObjectHolder ClassInstance::CallMethod(const Method& method, std::span<const ObjectHolder> actual_args,
+        Context& context)
+    {
+        if (ObjectHolder result; method.body->TryCall(*this, actual_args, context, result)) {
+            return result;
+        }
+        if (CallStack* stack = context.GetCallStack()) {
+            auto frame = stack->Push(method);
+            Closure& cls = frame.GetClosure();
+            cls[SELF_NAME] = ObjectHolder::Borrow(*this);
+            for (size_t i = 0; i < method.formal_params.size(); ++i) {
+                cls[method.formal_params[i]] = actual_args[i];
+            }
+            return method.body->Execute(cls, context);
+        }
 
-        auto ptr_method = class_.GetMethod(method);
         Closure cls;
-        cls["self"] = ObjectHolder::Share(*this);
+        cls[SELF_NAME] = ObjectHolder::Share(*this);
+        for (size_t i = 0; i < method.formal_params.size(); ++i) {
+            cls[method.formal_params[i]] = actual_args[i];
+        }
+        return method.body->Execute(cls, context);
+    }
+
+    namespace {
 
-        for (size_t i = 0; i < ptr_method->formal_params.size(); ++i) {
-            cls[ptr_method->formal_params[i]] = actual_args[i];
+        //  true,  name -  self      method
+        bool IsFrameVariable(const Method& method, const std::string& name) {
+            return name == SELF_NAME
+                || std::find(method.formal_params.begin(), method.formal_params.end(), name) != method.formal_params.end();
         }
-        return ptr_method->body->Execute(cls, context);
 
+        //    ,   self    method
+        void KeepFrameVariables(Closure& closure, const Method& method) {
+            for (auto it = closure.begin(); it != closure.end();) {
+                if (IsFrameVariable(method, it->first)) {
+                    ++it;
+                }
+                else {
+                    it = closure.erase(it);
+                }
+            }
+        }
+
+    }  // namespace
+
+    CallStack::Frame CallStack::Push(const Method& method) {
+        if (depth_ == slots_.size()) {
+            slots_.emplace_back();
+        }
+        Slot& slot = slots_[depth_++];
+        if (slot.method != &method) {
+            //         
+            KeepFrameVariables(slot.closure, method);
+            slot.method = &method;
+        }
+        return Frame(*this, slot);
+    }
+
+    CallStack::Frame::~Frame() {
+        //         .  
+        //    
+        KeepFrameVariables(slot_.closure, *slot_.method);
+        for (auto& [name, value] : slot_.closure) {
+            value = ObjectHolder::None();
+        }
+        --stack_.depth_;
     }
 
     Class::Class(std::string name, std::vector<Method> methods, const Class* parent)
@@ -119,7 +235,7 @@ namespace runtime {
         return name_;
     }
 
-    void Class::Print(ostream& os, Context& context) {
+    void Class::Print(ostream& os, [[maybe_unused]] Context& context) {
         os << "Class " << name_;
     }
 
@@ -127,21 +243,145 @@ namespace runtime {
         os << (GetValue() ? "True"sv : "False"sv);
     }
 
+    namespace {
+
+        //     object  nullptr.  BigNumber  ,
+        //  Number   storage
+        const BigInteger* AsBigInteger(const ObjectHolder& object, std::optional<BigInteger>& storage) {
+            if (auto number = object.TryAs<Number>()) return &storage.emplace(number->GetValue());
+            if (auto big = object.TryAs<BigNumber>()) return &big->GetValue();
+            return nullptr;
+        }
+
+        ObjectHolder FromBigInteger(BigInteger value) {
+            if (value.FitsInt64()) return ObjectHolder::Own(Number{ value.ToInt64() });
+            return ObjectHolder::Own(BigNumber{ std::move(value) });
+        }
+
+        //         
+        template <typename Operation>
+        ObjectHolder BigIntegerOperation(const ObjectHolder& lhs, const ObjectHolder& rhs, Operation operation) {
+            std::optional<BigInteger> lhs_storage;
+            std::optional<BigInteger> rhs_storage;
+            auto lhs_value = AsBigInteger(lhs, lhs_storage);
+            auto rhs_value = AsBigInteger(rhs, rhs_storage);
+            if (!lhs_value || !rhs_value) return {};
+            return FromBigInteger(operation(*lhs_value, *rhs_value));
+        }
+
+    }  // namespace
+
+    ObjectHolder AddIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        return BigIntegerOperation(lhs, rhs, std::plus<>{});
+    }
+
+    ObjectHolder SubtractIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        return BigIntegerOperation(lhs, rhs, std::minus<>{});
+    }
+
+    ObjectHolder MultiplyIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        return BigIntegerOperation(lhs, rhs, std::multiplies<>{});
+    }
+
+    ObjectHolder DivideIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs) {
+        return BigIntegerOperation(lhs, rhs, [](const BigInteger& dividend, const BigInteger& divisor) {
+            if (divisor.IsZero()) throw std::runtime_error("You can't divide by zero!"s);
+            return dividend / divisor;
+        });
+    }
+
+    ObjectHolder ToString(const ObjectHolder& object, Context& context) {
+        static const String none_str = String::Intern("None"sv);
+        static const String true_str = String::Intern("True"sv);
+        static const String false_str = String::Intern("False"sv);
+
+        if (!object) return ObjectHolder::Own(String(none_str));
+        if (auto str = object.TryAs<String>()) {
+            //  ,       .  
+            //     
+            return str->IsOwned() ? object : ObjectHolder::Own(String(*str));
+        }
+
+        if (auto number = object.TryAs<Number>()) {
+            char buffer[32];
+            auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), number->GetValue());
+            assert(error == std::errc{});
+            return ObjectHolder::Own(String(std::string(buffer, end)));
+        }
+        if (auto boolean = object.TryAs<Bool>()) {
+            return ObjectHolder::Own(String(boolean->GetValue() ? true_str : false_str));
+        }
+        if (auto big = object.TryAs<BigNumber>()) {
+            return ObjectHolder::Own(String(big->GetValue().ToString()));
+        }
+        if (auto instance = object.TryAs<ClassInstance>()) {
+            if (const Method* method = instance->FindMethod(STR_METHOD, 0)) {
+                //       ,   
+                ObjectHolder self = object;
+                return ToString(instance->CallMethod(*method, {}, context), context);
+            }
+        }
+
+        //     __str__  ,     
+        std::ostringstream out;
+        object->Print(out, context);
+        return ObjectHolder::Own(String(std::move(out).str()));
+    }
+
+    void WriteObject(const ObjectHolder& object, OutputSink& out, Context& context) {
+        if (!object) {
+            out.Write("None"sv);
+        }
+        else if (auto str = object.TryAs<String>()) {
+            out.Write(str->GetView());
+        }
+        else if (auto number = object.TryAs<Number>()) {
+            char buffer[32];
+            auto [end, error] = std::to_chars(std::begin(buffer), std::end(buffer), number->GetValue());
+            assert(error == std::errc{});
+            out.Write(std::string_view(buffer, static_cast<size_t>(end - buffer)));
+        }
+        else if (auto boolean = object.TryAs<Bool>()) {
+            out.Write(boolean->GetValue() ? "True"sv : "False"sv);
+        }
+        else if (auto big = object.TryAs<BigNumber>()) {
+            out.Write(big->GetValue().ToString());
+        }
+        else if (auto instance = object.TryAs<ClassInstance>(); instance && instance->HasMethod(STR_METHOD, 0)) {
+            ObjectHolder self = object;
+            WriteObject(instance->CallMethod(*instance->FindMethod(STR_METHOD, 0), {}, context), out, context);
+        }
+        else {
+            SinkStream stream(out);
+            object->Print(stream, context);
+        }
+    }
+
     bool Equal(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
         auto lhs_ptr_number = lhs.TryAs<Number>();
         auto rhs_ptr_number = rhs.TryAs<Number>();
         if (lhs_ptr_number && rhs_ptr_number) return lhs_ptr_number->GetValue() == rhs_ptr_number->GetValue();
+        if (lhs.TryAs<BigNumber>() || rhs.TryAs<BigNumber>()) {
+            std::optional<BigInteger> lhs_storage;
+            std::optional<BigInteger> rhs_storage;
+            auto lhs_value = AsBigInteger(lhs, lhs_storage);
+            auto rhs_value = AsBigInteger(rhs, rhs_storage);
+            if (lhs_value && rhs_value) return *lhs_value == *rhs_value;
+        }
 
         auto lhs_ptr_str = lhs.TryAs<String>();
         auto rhs_ptr_str = rhs.TryAs<String>();
-        if (lhs_ptr_str && rhs_ptr_str) return lhs_ptr_str->GetValue() == rhs_ptr_str->GetValue();
+        if (lhs_ptr_str && rhs_ptr_str) return *lhs_ptr_str == *rhs_ptr_str;
 
         auto lhs_ptr_bool = lhs.TryAs<Bool>();
         auto rhs_ptr_bool = rhs.TryAs<Bool>();
         if (lhs_ptr_bool && rhs_ptr_bool) return lhs_ptr_bool->GetValue() == rhs_ptr_bool->GetValue();
 
         auto lhs_ptr_class = lhs.TryAs<ClassInstance>();
-        if (lhs_ptr_class && lhs_ptr_class->HasMethod("__eq__", 1)) return lhs_ptr_class->Call("__eq__", { rhs }, context).TryAs<Bool>()->GetValue();
+        if (const Method* method = lhs_ptr_class ? lhs_ptr_class->FindMethod(EQ_METHOD, 1) : nullptr) {
+            ObjectHolder self = lhs;
+            return lhs_ptr_class->CallMethod(*method, std::span(&rhs, 1), context).TryAs<Bool>()->GetValue();
+        }
 
         if (!lhs && !rhs) return true;
 
@@ -152,17 +392,27 @@ namespace runtime {
         auto lhs_ptr_number = lhs.TryAs<Number>();
         auto rhs_ptr_number = rhs.TryAs<Number>();
         if (lhs_ptr_number && rhs_ptr_number) return lhs_ptr_number->GetValue() < rhs_ptr_number->GetValue();
+        if (lhs.TryAs<BigNumber>() || rhs.TryAs<BigNumber>()) {
+            std::optional<BigInteger> lhs_storage;
+            std::optional<BigInteger> rhs_storage;
+            auto lhs_value = AsBigInteger(lhs, lhs_storage);
+            auto rhs_value = AsBigInteger(rhs, rhs_storage);
+            if (lhs_value && rhs_value) return *lhs_value < *rhs_value;
+        }
 
         auto lhs_ptr_str = lhs.TryAs<String>();
         auto rhs_ptr_str = rhs.TryAs<String>();
-        if (lhs_ptr_str && rhs_ptr_str) return lhs_ptr_str->GetValue() < rhs_ptr_str->GetValue();
+        if (lhs_ptr_str && rhs_ptr_str) return lhs_ptr_str->GetView() < rhs_ptr_str->GetView();
 
         auto lhs_ptr_bool = lhs.TryAs<Bool>();
         auto rhs_ptr_bool = rhs.TryAs<Bool>();
         if (lhs_ptr_bool && rhs_ptr_bool) return lhs_ptr_bool->GetValue() < rhs_ptr_bool->GetValue();
 
         auto lhs_ptr_class = lhs.TryAs<ClassInstance>();
-        if (lhs_ptr_class && lhs_ptr_class->HasMethod("__lt__", 1)) return lhs_ptr_class->Call("__lt__", { rhs }, context).TryAs<Bool>()->GetValue();
+        if (const Method* method = lhs_ptr_class ? lhs_ptr_class->FindMethod(LT_METHOD, 1) : nullptr) {
+            ObjectHolder self = lhs;
+            return lhs_ptr_class->CallMethod(*method, std::span(&rhs, 1), context).TryAs<Bool>()->GetValue();
+        }
 
         throw std::runtime_error("Cannot compare objects for less"s);
     }
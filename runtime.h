@@ -1,47 +1,199 @@
 #pragma once
 
+#include "bigint.h"
+#include "heap.h"
+#include "output.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <new>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace runtime {
 
+    class CallStack;
+
     //    Mython
     class Context {
     public:
         //      print
         virtual std::ostream& GetOutputStream() = 0;
+        //     print.      GetOutputStream() 
+        virtual OutputSink& GetOutput() = 0;
+        //     .       Closure
+        virtual CallStack* GetCallStack() noexcept {
+            return nullptr;
+        }
 
     protected:
         ~Context() = default;
     };
 
-    //       Mython
+    //       Mython.
+    //      ,   ObjectHolder.
+    //     ,   
     class Object {
     public:
+        Object() = default;
+        //  (   )  :  -   
+        Object(const Object& /*other*/) noexcept {
+        }
+        Object& operator=(const Object& /*other*/) noexcept {
+            return *this;
+        }
+
         virtual ~Object() = default;
         //   os     
         virtual void Print(std::ostream& os, Context& context) = 0;
+
+        //      .
+        //   ,      
+        void MakeThreadShared() const noexcept {
+            thread_shared_ = true;
+        }
+
+        [[nodiscard]] bool IsThreadShared() const noexcept {
+            return thread_shared_;
+        }
+
+        //  true,        (  
+        // ObjectHolder::Own)
+        [[nodiscard]] bool IsOwned() const noexcept {
+            return owned_;
+        }
+
+        [[nodiscard]] std::uint32_t GetRefCount() const noexcept {
+            return ref_count_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        friend class ObjectHolder;
+        friend class Heap;
+
+        void AddRef() const noexcept {
+            if (thread_shared_) {
+                ref_count_.fetch_add(1, std::memory_order_relaxed);
+            }
+            else {
+                ref_count_.store(ref_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+        }
+
+        //  true,       
+        bool Release() const noexcept {
+            if (thread_shared_) {
+                return ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+            }
+            const std::uint32_t count = ref_count_.load(std::memory_order_relaxed) - 1;
+            ref_count_.store(count, std::memory_order_relaxed);
+            return count == 0;
+        }
+
+        mutable std::atomic<std::uint32_t> ref_count_{ 0 };
+        mutable bool thread_shared_ = false;
+        bool owned_ = false;
+        //      
+        bool in_heap_ = false;
+        //   GcNode
+        bool gc_node_ = false;
     };
 
-    //  -,      Mython-
+    //  -,      Mython-.
+    // ,   ,    .  ObjectHolder 
+    //    ,        
     class ObjectHolder {
     public:
         //   
         ObjectHolder() = default;
 
+        //    (. Borrow)       
+        ObjectHolder(const ObjectHolder& other) noexcept
+            : data_(other.data_) {
+            if (data_ & BORROWED) {
+                if (Get()->IsOwned()) {
+                    data_ &= ~BORROWED;
+                    Get()->AddRef();
+                }
+            }
+            else if (data_ != 0) {
+                Get()->AddRef();
+            }
+        }
+
+        ObjectHolder(ObjectHolder&& other) noexcept
+            : data_(std::exchange(other.data_, 0)) {
+        }
+
+        ObjectHolder& operator=(const ObjectHolder& rhs) noexcept {
+            ObjectHolder(rhs).Swap(*this);
+            return *this;
+        }
+
+        ObjectHolder& operator=(ObjectHolder&& rhs) noexcept {
+            ObjectHolder(std::move(rhs)).Swap(*this);
+            return *this;
+        }
+
+        ~ObjectHolder() {
+            if (IsCounted() && Get()->Release()) Heap::Destroy(Get());
+        }
+
         //  ObjectHolder,    T
         //  T -  - Object.
-        // object     
+        // object     .      ,
+        //    
         template <typename T>
         [[nodiscard]] static ObjectHolder Own(T&& object) {
-            return ObjectHolder(std::make_shared<T>(std::forward<T>(object)));
+            constexpr bool fits_heap = sizeof(T) <= Heap::MAX_OBJECT_SIZE && alignof(T) <= Heap::GRANULARITY;
+            Heap* heap = fits_heap ? Heap::Current() : nullptr;
+            if (!heap) {
+                T* data = new T(std::forward<T>(object));
+                data->owned_ = true;
+                return ObjectHolder(data);
+            }
+
+            void* memory = heap->Allocate(sizeof(T), alignof(T));
+            T* data = nullptr;
+            try {
+                data = new (memory) T(std::forward<T>(object));
+            }
+            catch (...) {
+                Heap::Free(memory);
+                throw;
+            }
+            data->owned_ = true;
+            data->in_heap_ = true;
+            data->gc_node_ = std::is_base_of_v<GcNode, T>;
+
+            ObjectHolder result(data);
+            if constexpr (std::is_base_of_v<GcNode, T>) {
+                heap->Track(*data);
+            }
+            return result;
         }
 
-        //  ObjectHolder,    (  )
+        //  ObjectHolder    .     Own,
+        // ObjectHolder    ,     (  )
         [[nodiscard]] static ObjectHolder Share(Object& object);
+        //    ,     .  ,  
+        //   .        Share
+        [[nodiscard]] static ObjectHolder Borrow(Object& object) noexcept {
+            ObjectHolder result;
+            result.data_ = reinterpret_cast<std::uintptr_t>(&object) | BORROWED;
+            return result;
+        }
         //   ObjectHolder,   None
         [[nodiscard]] static ObjectHolder None();
 
@@ -51,7 +203,9 @@ namespace runtime {
 
         Object* operator->() const;
 
-        [[nodiscard]] Object* Get() const;
+        [[nodiscard]] Object* Get() const {
+            return reinterpret_cast<Object*>(data_ & ~BORROWED);
+        }
 
         //      T  nullptr,   ObjectHolder  
         //   
@@ -61,13 +215,42 @@ namespace runtime {
         }
 
         //  true,  ObjectHolder  
-        explicit operator bool() const;
+        explicit operator bool() const {
+            return data_ != 0;
+        }
+
+        void Swap(ObjectHolder& other) noexcept {
+            std::swap(data_, other.data_);
+        }
+
+        //         .  
+        //   Mython,       
+        void Pin() noexcept {
+            if ((data_ & BORROWED) && Get()->IsOwned()) {
+                data_ &= ~BORROWED;
+                Get()->AddRef();
+            }
+        }
+
+        //  true,   ObjectHolder -    .
+        //      :     
+        [[nodiscard]] bool IsUnique() const noexcept {
+            return IsCounted() && Get()->GetRefCount() == 1;
+        }
 
     private:
-        explicit ObjectHolder(std::shared_ptr<Object> data);
+        //     data
+        explicit ObjectHolder(Object* data) noexcept;
         void AssertIsValid() const;
 
-        std::shared_ptr<Object> data_;
+        [[nodiscard]] bool IsCounted() const noexcept {
+            return data_ != 0 && (data_ & BORROWED) == 0;
+        }
+
+        static constexpr std::uintptr_t BORROWED = 1;
+        static_assert(alignof(Object) > BORROWED);
+
+        std::uintptr_t data_ = 0;
     };
 
     // -,    T
@@ -75,7 +258,7 @@ namespace runtime {
     class ValueObject : public Object {
     public:
         ValueObject(T v)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
-            : value_(v) {
+            : value_(std::move(v)) {
         }
 
         void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
@@ -86,6 +269,11 @@ namespace runtime {
             return value_;
         }
 
+        //  . ,        (. ObjectHolder::IsUnique)
+        void SetValue(T v) {
+            value_ = std::move(v);
+        }
+
     private:
         T value_;
     };
@@ -93,10 +281,58 @@ namespace runtime {
     //  ,      
     using Closure = std::unordered_map<std::string, ObjectHolder>;
 
+    //  ,       
+    inline const std::string SELF_NAME = "self";
+
+    /*
+     *    .  INLINE_CAPACITY     ,
+     *         
+     */
+    class Arguments {
+    public:
+        static constexpr size_t INLINE_CAPACITY = 4;
+
+        explicit Arguments(size_t size)
+            : size_(size) {
+            if (size_ > INLINE_CAPACITY) heap_.resize(size_);
+        }
+
+        Arguments(const Arguments&) = delete;
+        Arguments& operator=(const Arguments&) = delete;
+
+        ObjectHolder& operator[](size_t index) noexcept {
+            return Data()[index];
+        }
+
+        operator std::span<const ObjectHolder>() const noexcept {  // NOLINT(google-explicit-constructor)
+            return { size_ > INLINE_CAPACITY ? heap_.data() : inline_.data(), size_ };
+        }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return size_;
+        }
+
+    private:
+        ObjectHolder* Data() noexcept {
+            return size_ > INLINE_CAPACITY ? heap_.data() : inline_.data();
+        }
+
+        std::array<ObjectHolder, INLINE_CAPACITY> inline_;
+        std::vector<ObjectHolder> heap_;
+        size_t size_;
+    };
+
     // ,    object ,   True
     //     , True     true.    - false.
     bool IsTrue(const ObjectHolder& object);
 
+    class Executable;
+    class ClassInstance;
+
+    //      (. Executable::VisitChildren).
+    //      
+    using ChildVisitor = std::function<void(std::unique_ptr<Executable>&)>;
+
     //       Mython
     class Executable {
     public:
@@ -104,12 +340,213 @@ namespace runtime {
         //      closure,  context
         //     None
         virtual ObjectHolder Execute(Closure& closure, Context& context) = 0;
+
+        //     .    Execute   
+        //  (. ObjectHolder::Borrow)  ,     . 
+        // ,     Mython    .  
+        //    (ObjectHolder::Pin),        
+        virtual ObjectHolder Evaluate(Closure& closure, Context& context) {
+            return Execute(closure, context);
+        }
+
+        //   ,   bool   IsTrue.   
+        //   ,          Bool
+        virtual bool EvaluateCondition(Closure& closure, Context& context) {
+            return IsTrue(Evaluate(closure, context));
+        }
+
+        //  true,  Execute    Mython    . ,
+        //    ,  
+        [[nodiscard]] virtual bool IsPure() const noexcept {
+            return false;
+        }
+
+        //  visitor    .  , 
+        //     
+        virtual void VisitChildren(const ChildVisitor& /*visitor*/) {
+        }
+
+        //     self    args   ,
+        //    (. jit.h  native.h).  false,    
+        //  ,   result  
+        virtual bool TryCall(ClassInstance& /*self*/, std::span<const ObjectHolder> /*args*/, Context& /*context*/,
+                             ObjectHolder& /*result*/) {
+            return false;
+        }
+    };
+
+    /*
+     *   .   Step()    
+     *      .      (. Exchange), 
+     *    ,         stack_limit_,
+     *  OnExhausted.        .
+     *        
+     */
+    class StepBudget {
+    public:
+        //  true,     
+        [[nodiscard]] static bool IsActive() noexcept {
+            return current_ != nullptr;
+        }
+
+        static void Step() {
+            if (StepBudget* budget = current_) {
+                char marker;
+                if (--budget->remaining_ <= 0 || reinterpret_cast<std::uintptr_t>(&marker) < budget->stack_limit_) {
+                    budget->OnExhausted();
+                }
+            }
+        }
+
+    protected:
+        StepBudget() = default;
+        ~StepBudget() = default;
+
+        virtual void OnExhausted() = 0;
+
+        //         
+        static StepBudget* Exchange(StepBudget* budget) noexcept {
+            return std::exchange(current_, budget);
+        }
+
+        std::int64_t remaining_ = 0;
+        //   ,      . 0 -  
+        std::uintptr_t stack_limit_ = 0;
+
+    private:
+        static inline thread_local StepBudget* current_ = nullptr;
     };
 
-    //  
-    using String = ValueObject<std::string>;
-    //  
-    using Number = ValueObject<int>;
+    /*
+     *  .  -    ,    :
+     *    s + t,  s   ,  t   s,
+     *   s.     s = s + line   
+     *  .   :       .
+     *
+     *     (. Intern):   
+     *     ,         ,
+     *    .         .
+     */
+    class String : public Object {
+    public:
+        String(std::string value)  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+            : buffer_(new Buffer{ std::move(value), true })
+            , size_(buffer_->data.size()) {
+        }
+
+        //   lhs + rhs
+        [[nodiscard]] static String Concat(const String& lhs, const String& rhs);
+
+        //     value     
+        [[nodiscard]] static String Intern(std::string_view value);
+
+        [[nodiscard]] bool IsInterned() const noexcept {
+            return interned_;
+        }
+
+        //    
+        [[nodiscard]] size_t GetHash() const noexcept {
+            if (!hash_known_) {
+                hash_ = std::hash<std::string_view>{}(GetView());
+                hash_known_ = true;
+            }
+            return hash_;
+        }
+
+        friend bool operator==(const String& lhs, const String& rhs) noexcept;
+
+        void Print(std::ostream& os, [[maybe_unused]] Context& context) override {
+            os << GetView();
+        }
+
+        //     
+        [[nodiscard]] std::string_view GetView() const noexcept {
+            return std::string_view(buffer_->data).substr(0, size_);
+        }
+
+        //    
+        [[nodiscard]] std::string GetValue() const {
+            return std::string(GetView());
+        }
+
+    private:
+        struct Buffer {
+            std::string data;
+            //     , ,      
+            bool frozen;
+            //       ,      
+            bool immortal = false;
+            std::uint32_t ref_count = 1;
+        };
+
+        /*
+         *      .   :  
+         *      ,     
+         */
+        class BufferRef {
+        public:
+            //  ,   ref_count  
+            explicit BufferRef(Buffer* buffer) noexcept
+                : buffer_(buffer) {
+            }
+
+            BufferRef(const BufferRef& other) noexcept
+                : buffer_(other.buffer_) {
+                if (buffer_ && !buffer_->immortal) ++buffer_->ref_count;
+            }
+
+            BufferRef(BufferRef&& other) noexcept
+                : buffer_(std::exchange(other.buffer_, nullptr)) {
+            }
+
+            BufferRef& operator=(const BufferRef& rhs) noexcept {
+                BufferRef(rhs).Swap(*this);
+                return *this;
+            }
+
+            BufferRef& operator=(BufferRef&& rhs) noexcept {
+                BufferRef(std::move(rhs)).Swap(*this);
+                return *this;
+            }
+
+            ~BufferRef() {
+                if (buffer_ && !buffer_->immortal && --buffer_->ref_count == 0) delete buffer_;
+            }
+
+            Buffer* operator->() const noexcept {
+                return buffer_;
+            }
+
+            [[nodiscard]] Buffer* Get() const noexcept {
+                return buffer_;
+            }
+
+            void Swap(BufferRef& other) noexcept {
+                std::swap(buffer_, other.buffer_);
+            }
+
+        private:
+            Buffer* buffer_ = nullptr;
+        };
+
+        String(BufferRef buffer, size_t size) noexcept
+            : buffer_(std::move(buffer))
+            , size_(size) {
+        }
+
+        BufferRef buffer_;
+        size_t size_;
+        mutable size_t hash_ = 0;
+        mutable bool hash_known_ = false;
+        bool interned_ = false;
+    };
+
+    bool operator==(const String& lhs, const String& rhs) noexcept;
+    //  ,   64 
+    using Number = ValueObject<std::int64_t>;
+    //  ,    Number.      ,
+    //  BigNumber      int64_t
+    using BigNumber = ValueObject<BigInteger>;
 
     //  
     class Bool : public ValueObject<bool> {
@@ -151,7 +588,7 @@ namespace runtime {
     };
 
     //  
-    class ClassInstance : public Object {
+    class ClassInstance : public Object, public GcNode {
     public:
         explicit ClassInstance(const Class& cls);
 
@@ -170,8 +607,19 @@ namespace runtime {
         ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actual_args,
             Context& context);
 
+        //   method,   FindMethod.  context   ,
+        //    ,  self   :  
+        // ,   .         
+        ObjectHolder CallMethod(const Method& method, std::span<const ObjectHolder> actual_args, Context& context);
+
         //  true,     method,  argument_count 
         [[nodiscard]] bool HasMethod(const std::string& method, size_t argument_count) const;
+        //   method,  argument_count ,  nullptr
+        [[nodiscard]] const Method* FindMethod(const std::string& method, size_t argument_count) const;
+
+        [[nodiscard]] const Class& GetClass() const noexcept {
+            return class_;
+        }
 
         //    Closure,   
         [[nodiscard]] Closure& Fields();
@@ -210,6 +658,30 @@ namespace runtime {
     //  ,  Less(lhs, rhs, context)
     bool GreaterOrEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
 
+    /*
+     *  ,     object  print.   
+     *  ,    ,  ,   __str__,
+     *    .
+     *
+     *  context      __str__
+     */
+    ObjectHolder ToString(const ObjectHolder& object, Context& context);
+
+    /*
+     *    Number  BigNumber. ,   64 ,  
+     * Number,  -  BigNumber.    ObjectHolder,    
+     *      .
+     *     Number     
+     */
+    ObjectHolder AddIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder SubtractIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    ObjectHolder MultiplyIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs);
+    //  std::runtime_error    
+    ObjectHolder DivideIntegers(const ObjectHolder& lhs, const ObjectHolder& rhs);
+
+    //   out  ,   ToString(object, context),    
+    void WriteObject(const ObjectHolder& object, OutputSink& out, Context& context);
+
     // -,   .
     //           output
     struct DummyContext : Context {
@@ -217,22 +689,108 @@ namespace runtime {
             return output;
         }
 
+        OutputSink& GetOutput() override {
+            return sink;
+        }
+
         std::ostringstream output;
+        StreamOutput sink{ output };
     };
 
-    //  ,       output,   
+    /*
+     *      .  -  Closure,   
+     *          self  .     
+     *     ,      
+     *   .     ,   
+     *   .
+     *        
+     */
+    class CallStack {
+        struct Slot {
+            Closure closure;
+            const Method* method = nullptr;
+        };
+
+    public:
+        //  .           
+        class Frame {
+        public:
+            Frame(const Frame&) = delete;
+            Frame& operator=(const Frame&) = delete;
+            ~Frame();
+
+            [[nodiscard]] Closure& GetClosure() noexcept {
+                return slot_.closure;
+            }
+
+        private:
+            friend class CallStack;
+
+            Frame(CallStack& stack, Slot& slot) noexcept
+                : stack_(stack)
+                , slot_(slot) {
+            }
+
+            CallStack& stack_;
+            Slot& slot_;
+        };
+
+        //      method
+        [[nodiscard]] Frame Push(const Method& method);
+
+        [[nodiscard]] size_t GetDepth() const noexcept {
+            return depth_;
+        }
+
+        // ,     return   
+        void SetReturnValue(ObjectHolder value) noexcept {
+            return_value_ = std::move(value);
+        }
+
+        [[nodiscard]] ObjectHolder TakeReturnValue() noexcept {
+            return std::move(return_value_);
+        }
+
+    private:
+        //   deque      
+        std::deque<Slot> slots_;
+        size_t depth_ = 0;
+        ObjectHolder return_value_;
+    };
+
+    //  ,         output,   
     class SimpleContext : public runtime::Context {
     public:
         explicit SimpleContext(std::ostream& output)
-            : output_(output) {
+            : stream_sink_(std::in_place, output)
+            , output_(*stream_sink_)
+            , stream_(output) {
+        }
+
+        explicit SimpleContext(OutputSink& output)
+            : sink_stream_(std::in_place, output)
+            , output_(output)
+            , stream_(*sink_stream_) {
         }
 
         std::ostream& GetOutputStream() override {
+            return stream_;
+        }
+
+        OutputSink& GetOutput() override {
             return output_;
         }
 
+        CallStack* GetCallStack() noexcept override {
+            return &call_stack_;
+        }
+
     private:
-        std::ostream& output_;
+        CallStack call_stack_;
+        std::optional<StreamOutput> stream_sink_;
+        std::optional<SinkStream> sink_stream_;
+        OutputSink& output_;
+        std::ostream& stream_;
     };
 
 }  // namespace runtime
\ No newline at end of file
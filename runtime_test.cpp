@@ -1,7 +1,11 @@
 #include "runtime.h"
 #include "test_runner_p.h"
 
+#include <cstdio>
 #include <functional>
+#include <limits>
+#include <system_error>
+#include <thread>
 
 using namespace std;
 
@@ -19,7 +23,8 @@ namespace runtime {
             }
 
             Logger(const Logger& rhs)
-                : id_(rhs.id_)  //
+                : Object()
+                , id_(rhs.id_)  //
             {
                 ++instance_count;
             }
@@ -52,6 +57,23 @@ namespace runtime {
 
         int Logger::instance_count = 0;
 
+        // ,    
+        struct CopyCounter {
+            CopyCounter() = default;
+            CopyCounter(const CopyCounter& other)
+                : copies(other.copies + 1) {
+            }
+            CopyCounter(CopyCounter&&) noexcept = default;
+            CopyCounter& operator=(const CopyCounter&) = default;
+            CopyCounter& operator=(CopyCounter&&) noexcept = default;
+
+            int copies = 0;
+        };
+
+        ostream& operator<<(ostream& os, const CopyCounter& counter) {
+            return os << counter.copies;
+        }
+
         void TestNumber() {
             Number num(127);
 
@@ -71,6 +93,187 @@ namespace runtime {
             ASSERT_EQUAL(word.GetValue(), "hello!"s);
         }
 
+        void TestStringConcat() {
+            String hello("hello"s);
+            String first = String::Concat(hello, String(", "s));
+            String second = String::Concat(first, String("world"s));
+            // first     ,      
+            String third = String::Concat(first, String("there"s));
+            String doubled = String::Concat(second, second);
+
+            ASSERT_EQUAL(hello.GetView(), "hello"sv);
+            ASSERT_EQUAL(first.GetView(), "hello, "sv);
+            ASSERT_EQUAL(second.GetView(), "hello, world"sv);
+            ASSERT_EQUAL(third.GetView(), "hello, there"sv);
+            ASSERT_EQUAL(doubled.GetView(), "hello, worldhello, world"sv);
+
+            const std::string& value = second.GetValue();
+            String fourth = String::Concat(second, String("!"s));
+            ASSERT_EQUAL(value, "hello, world"s);
+            ASSERT_EQUAL(fourth.GetValue(), "hello, world!"s);
+            ASSERT_EQUAL(first.GetValue(), "hello, "s);
+
+            DummyContext context;
+            fourth.Print(context.output, context);
+            ASSERT_EQUAL(context.output.str(), "hello, world!"s);
+        }
+
+        void TestStringIntern() {
+            String a = String::Intern("tag"sv);
+            String b = String::Intern("tag"sv);
+            String other = String::Intern("other"sv);
+            String built = String::Concat(String("ta"s), String("g"s));
+
+            ASSERT(a.IsInterned() && b.IsInterned());
+            ASSERT(!built.IsInterned());
+            ASSERT_EQUAL(a.GetView().data(), b.GetView().data());
+            ASSERT(a == b);
+            ASSERT(!(a == other));
+            ASSERT(a == built);
+            ASSERT_EQUAL(a.GetHash(), built.GetHash());
+
+            ObjectHolder lhs = ObjectHolder::Own(String(a));
+            ObjectHolder rhs = ObjectHolder::Own(std::move(built));
+            DummyContext context;
+            ASSERT(Equal(lhs, rhs, context));
+        }
+
+        void TestToString() {
+            DummyContext context;
+            auto str = [&context](const ObjectHolder& object) {
+                return std::string(ToString(object, context).TryAs<String>()->GetView());
+            };
+
+            ASSERT_EQUAL(str(ObjectHolder::Own(Number{ -2147483647 - 1 })), "-2147483648"s);
+            ASSERT_EQUAL(str(ObjectHolder::Own(Bool{ true })), "True"s);
+            ASSERT_EQUAL(str(ObjectHolder::Own(Bool{ false })), "False"s);
+            ASSERT_EQUAL(str(ObjectHolder::None()), "None"s);
+
+            ObjectHolder owned = ObjectHolder::Own(String("text"s));
+            ASSERT_EQUAL(ToString(owned, context).Get(), owned.Get());
+
+            String local("local"s);
+            ObjectHolder copy = ToString(ObjectHolder::Share(local), context);
+            ASSERT(copy.Get() != &local);
+            ASSERT_EQUAL(copy.TryAs<String>()->GetView(), "local"sv);
+            ASSERT(context.output.str().empty());
+        }
+
+        void TestFdOutput() {
+            std::FILE* file = std::tmpfile();
+            ASSERT(file != nullptr);
+            auto contents = [file] {
+                std::string result(64, '\0');
+                std::fseek(file, 0, SEEK_SET);
+                result.resize(std::fread(result.data(), 1, result.size(), file));
+                std::fseek(file, 0, SEEK_END);
+                return result;
+            };
+
+            {
+                FdOutput output(fileno(file), { FlushPolicy::SIZE, 8 });
+                output.Write("abc"sv);
+                ASSERT_EQUAL(contents(), ""s);
+                output.Write("defghi"sv);
+                ASSERT_EQUAL(contents(), "abc"s);
+                output.Write("0123456789"sv);
+                ASSERT_EQUAL(contents(), "abcdefghi0123456789"s);
+                output.Write("\n"sv);
+            }
+            ASSERT_EQUAL(contents(), "abcdefghi0123456789\n"s);
+
+            {
+                FdOutput output(fileno(file), { FlushPolicy::LINE, 8 });
+                output.Write("x"sv);
+                ASSERT_EQUAL(contents().size(), 20U);
+                output.Write("\n"sv);
+                ASSERT_EQUAL(contents().size(), 22U);
+            }
+            std::fclose(file);
+        }
+
+        void TestAsyncFdOutput() {
+            std::FILE* file = std::tmpfile();
+            ASSERT(file != nullptr);
+
+            std::string expected;
+            {
+                AsyncFdOutput output(fileno(file), { FlushPolicy::SIZE, 4096, true });
+                for (int i = 0; i < 100'000; ++i) {
+                    const std::string line = std::to_string(i) + "\n"s;
+                    output.Write(line);
+                    expected += line;
+                }
+            }
+
+            std::string written(expected.size() + 1, '\0');
+            std::fseek(file, 0, SEEK_SET);
+            written.resize(std::fread(written.data(), 1, written.size(), file));
+            ASSERT(written == expected);
+            std::fclose(file);
+
+            //        Flush
+            AsyncFdOutput broken(-1);
+            broken.Write("lost"sv);
+            bool thrown = false;
+            try {
+                broken.Flush();
+            }
+            catch (const std::system_error&) {
+                thrown = true;
+            }
+            ASSERT(thrown);
+        }
+
+        void TestBigInteger() {
+            const BigInteger max(std::numeric_limits<std::int64_t>::max());
+            const BigInteger min(std::numeric_limits<std::int64_t>::min());
+            ASSERT(max.FitsInt64() && min.FitsInt64());
+            ASSERT_EQUAL(min.ToInt64(), std::numeric_limits<std::int64_t>::min());
+
+            const BigInteger above = max + BigInteger(1);
+            ASSERT(!above.FitsInt64());
+            ASSERT_EQUAL(above.ToString(), "9223372036854775808"s);
+            ASSERT_EQUAL((min - BigInteger(1)).ToString(), "-9223372036854775809"s);
+            ASSERT(above - BigInteger(1) == max);
+
+            const BigInteger square = above * above;
+            ASSERT_EQUAL(square.ToString(), "85070591730234615865843651857942052864"s);
+            ASSERT(square / above == above);
+            ASSERT_EQUAL((square / BigInteger(-1000000007)).ToString(), "-85070591134740477922660306399"s);
+            ASSERT((-square) / square == BigInteger(-1));
+            ASSERT((square - BigInteger(1)) / above == above - BigInteger(1));
+            ASSERT(BigInteger(7) / square == BigInteger());
+            ASSERT(-square < min && min < above && !(above < above));
+
+            ASSERT(BigInteger::FromString("9223372036854775808"s) == above);
+            ASSERT(BigInteger::FromString("-85070591730234615865843651857942052864"s) == -square);
+            ASSERT(BigInteger::FromString("000"s) == BigInteger());
+            ASSERT_THROWS(static_cast<void>(BigInteger::FromString("12a"s)), std::invalid_argument);
+        }
+
+        void TestIntegerPromotion() {
+            auto max = ObjectHolder::Own(Number{ std::numeric_limits<std::int64_t>::max() });
+            auto one = ObjectHolder::Own(Number{ 1 });
+
+            auto sum = AddIntegers(max, one);
+            ASSERT(sum.TryAs<BigNumber>());
+            ASSERT_EQUAL(sum.TryAs<BigNumber>()->GetValue().ToString(), "9223372036854775808"s);
+
+            // ,    int64_t,    Number
+            auto back = SubtractIntegers(sum, one);
+            ASSERT(back.TryAs<Number>());
+            ASSERT_EQUAL(back.TryAs<Number>()->GetValue(), std::numeric_limits<std::int64_t>::max());
+
+            ASSERT(!AddIntegers(max, ObjectHolder::Own(String("1"s))));
+            ASSERT_THROWS(DivideIntegers(sum, ObjectHolder::Own(Number{ 0 })), std::runtime_error);
+
+            DummyContext context;
+            ASSERT(Less(max, sum, context));
+            ASSERT(!Equal(sum, max, context));
+            ASSERT(IsTrue(sum));
+        }
+
         void TestBool() {
             Bool t(true);
             ASSERT_EQUAL(t.GetValue(), true);
@@ -242,6 +445,43 @@ namespace runtime {
             }
         }
 
+        void TestShareOwned() {
+            ASSERT_EQUAL(Logger::instance_count, 0);
+            ObjectHolder shared;
+            {
+                auto owner = ObjectHolder::Own(Logger(42));
+                ASSERT_EQUAL(owner->GetRefCount(), 1U);
+                shared = ObjectHolder::Share(*owner);
+                ASSERT_EQUAL(owner->GetRefCount(), 2U);
+            }
+            ASSERT_EQUAL(Logger::instance_count, 1);
+            ASSERT_EQUAL(shared->GetRefCount(), 1U);
+            shared = ObjectHolder::None();
+            ASSERT_EQUAL(Logger::instance_count, 0);
+        }
+
+        void TestThreadShared() {
+            ASSERT_EQUAL(Logger::instance_count, 0);
+            {
+                auto oh = ObjectHolder::Own(Logger(7));
+                ASSERT(!oh->IsThreadShared());
+                oh->MakeThreadShared();
+
+                auto worker = [&oh] {
+                    for (int i = 0; i < 10000; ++i) {
+                        ObjectHolder copy = oh;
+                    }
+                };
+                std::thread first(worker);
+                std::thread second(worker);
+                first.join();
+                second.join();
+
+                ASSERT_EQUAL(oh->GetRefCount(), 1U);
+            }
+            ASSERT_EQUAL(Logger::instance_count, 0);
+        }
+
         void TestNullptr() {
             ObjectHolder oh;
             ASSERT(!oh);
@@ -529,17 +769,71 @@ namespace runtime {
             ASSERT_THROWS(instance.Call("missing_method"s, {}, ctx), runtime_error);
         }
 
+        void TestValueObjectMovesValue() {
+            ValueObject<CopyCounter> value{ CopyCounter{} };
+            ASSERT_EQUAL(value.GetValue().copies, 0);
+
+            auto holder = ObjectHolder::Own(ValueObject<CopyCounter>{ CopyCounter{} });
+            ASSERT_EQUAL(holder.TryAs<ValueObject<CopyCounter>>()->GetValue().copies, 0);
+            holder.TryAs<ValueObject<CopyCounter>>()->SetValue(CopyCounter{});
+            ASSERT_EQUAL(holder.TryAs<ValueObject<CopyCounter>>()->GetValue().copies, 0);
+        }
+
+        void TestCallStackReusesFrames() {
+            vector<Method> methods;
+            methods.push_back({ "method"s, {"arg"s}, make_unique<TestMethodBody>(
+                [](Closure&, Context&) { return ObjectHolder::None(); }) });
+            Class cls{ "Test"s, move(methods), nullptr };
+            const Method& method = *cls.GetMethod("method"s);
+
+            CallStack stack;
+            const Closure* first_closure = nullptr;
+            const void* first_node = nullptr;
+            {
+                auto frame = stack.Push(method);
+                ASSERT_EQUAL(stack.GetDepth(), 1U);
+                frame.GetClosure()["arg"s] = ObjectHolder::Own(Number{ 1 });
+                frame.GetClosure()["local"s] = ObjectHolder::Own(Number{ 2 });
+                first_closure = &frame.GetClosure();
+                first_node = &frame.GetClosure().at("arg"s);
+            }
+            ASSERT_EQUAL(stack.GetDepth(), 0U);
+            {
+                //              ,
+                //      
+                auto frame = stack.Push(method);
+                ASSERT_EQUAL(&frame.GetClosure(), first_closure);
+                ASSERT_EQUAL(static_cast<const void*>(&frame.GetClosure().at("arg"s)), first_node);
+                ASSERT(!frame.GetClosure().at("arg"s));
+                ASSERT_EQUAL(frame.GetClosure().count("local"s), 0U);
+
+                //     
+                auto nested = stack.Push(method);
+                ASSERT_EQUAL(stack.GetDepth(), 2U);
+                ASSERT(&nested.GetClosure() != first_closure);
+            }
+        }
+
     }  // namespace
 
     void RunObjectsTests(TestRunner& tr) {
         RUN_TEST(tr, runtime::TestNumber);
         RUN_TEST(tr, runtime::TestString);
+        RUN_TEST(tr, runtime::TestStringConcat);
+        RUN_TEST(tr, runtime::TestStringIntern);
+        RUN_TEST(tr, runtime::TestToString);
+        RUN_TEST(tr, runtime::TestFdOutput);
+        RUN_TEST(tr, runtime::TestAsyncFdOutput);
+        RUN_TEST(tr, runtime::TestBigInteger);
+        RUN_TEST(tr, runtime::TestIntegerPromotion);
         RUN_TEST(tr, runtime::TestBool);
         RUN_TEST(tr, runtime::TestMethodInvocation);
         RUN_TEST(tr, runtime::TestIsTrue);
         RUN_TEST(tr, runtime::TestComparison);
         RUN_TEST(tr, runtime::TestClass);
         RUN_TEST(tr, runtime::TestClassInstance);
+        RUN_TEST(tr, runtime::TestCallStackReusesFrames);
+        RUN_TEST(tr, runtime::TestValueObjectMovesValue);
     }
 
     void RunObjectHolderTests(TestRunner& tr) {
@@ -547,6 +841,8 @@ namespace runtime {
         RUN_TEST(tr, runtime::TestOwning);
         RUN_TEST(tr, runtime::TestMove);
         RUN_TEST(tr, runtime::TestNullptr);
+        RUN_TEST(tr, runtime::TestShareOwned);
+        RUN_TEST(tr, runtime::TestThreadShared);
     }
 
 }  // namespace runtime
\ No newline at end of file
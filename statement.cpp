@@ -1,5 +1,6 @@
 #include "statement.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -14,11 +15,44 @@ namespace ast {
     namespace {
         const string ADD_METHOD = "__add__"s;
         const string INIT_METHOD = "__init__"s;
+
+        //  True  False. Bool ,      
+        //         
+        runtime::Bool true_value{ true };
+        runtime::Bool false_value{ false };
+
+        ObjectHolder MakeBool(bool value) {
+            return ObjectHolder::Share(value ? true_value : false_value);
+        }
+
+        //    ,      
+        // (. Executable::IsPure).   ,   :   
+        //       
+        size_t FirstBorrowedArgument(const vector<unique_ptr<Statement>>& args) {
+            size_t first = args.size();
+            while (first > 0 && args[first - 1]->IsPure()) {
+                --first;
+            }
+            return first;
+        }
+
+        void EvaluateArguments(const vector<unique_ptr<Statement>>& args, size_t first_borrowed,
+            runtime::Arguments& values, Closure& closure, Context& context) {
+            for (size_t i = 0; i < args.size(); ++i) {
+                values[i] = i < first_borrowed ? args[i]->Execute(closure, context) : args[i]->Evaluate(closure, context);
+            }
+        }
+
     }  // namespace
 
     ObjectHolder Assignment::Execute(Closure& closure, Context& context) {
-        closure[var_] = move(rv_->Execute(closure, context));
-        return closure.at(var_);
+        //     :       
+        auto [it, inserted] = closure.insert_or_assign(var_, rv_->Execute(closure, context));
+        return it->second;
+    }
+
+    void Assignment::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(rv_);
     }
 
     Assignment::Assignment(std::string var, std::unique_ptr<Statement> rv)
@@ -31,7 +65,7 @@ namespace ast {
     VariableValue::VariableValue(std::vector<std::string> dotted_ids)
         : dotted_ids_(move(dotted_ids)) {}
 
-    ObjectHolder VariableValue::Execute(Closure& closure, Context& /*context*/) {
+    const ObjectHolder& VariableValue::Find(Closure& closure) const {
         Closure* ptr_clos = &closure;
         runtime::Closure::iterator it_object;
 
@@ -47,6 +81,15 @@ namespace ast {
         return it_object->second;
     }
 
+    ObjectHolder VariableValue::Execute(Closure& closure, Context& /*context*/) {
+        return Find(closure);
+    }
+
+    ObjectHolder VariableValue::Evaluate(Closure& closure, Context& /*context*/) {
+        const ObjectHolder& value = Find(closure);
+        return value ? ObjectHolder::Borrow(*value) : ObjectHolder::None();
+    }
+
     unique_ptr<Print> Print::Variable(const std::string& name) {
         return make_unique<Print>(make_unique<VariableValue>(name));
     }
@@ -59,135 +102,439 @@ namespace ast {
         : args_(move(args)) {}
 
     ObjectHolder Print::Execute(Closure& closure, Context& context) {
-        auto& out = context.GetOutputStream();
+        auto& out = context.GetOutput();
         ObjectHolder object;
 
         for (const auto& arg : args_) {
-            if (arg != args_.front()) out << " ";
+            if (arg != args_.front()) out.Write(" "sv);
 
-            object = arg->Execute(closure, context);
-
-            if (object) object->Print(out, context);
-            else out << "None";
+            object = arg->Evaluate(closure, context);
+            // __str__      ,  Print    
+            object.Pin();
+            runtime::WriteObject(object, out, context);
         }
-        out << "\n";
+        out.Write("\n"sv);
         return object;
     }
 
+    void Print::VisitChildren(const runtime::ChildVisitor& visitor) {
+        for (auto& arg : args_) {
+            visitor(arg);
+        }
+    }
+
     MethodCall::MethodCall(std::unique_ptr<Statement> object, std::string method,
         std::vector<std::unique_ptr<Statement>> args)
-        : object_(move(object)), method_(move(method)), args_(move(args)) {}
+        : object_(move(object)), method_(move(method)), args_(move(args))
+        , first_borrowed_arg_(FirstBorrowedArgument(args_)) {}
 
     ObjectHolder MethodCall::Execute(Closure& closure, Context& context) {
-        auto ptr_class = object_->Execute(closure, context).TryAs<runtime::ClassInstance>();
-        std::vector<runtime::ObjectHolder> args;
+        Count();
+        // ObjectHolder  ,    
+        return Invoke(object_->Execute(closure, context), closure, context);
+    }
 
-        for (const auto& arg : args_) {
-            args.push_back(std::move(arg->Execute(closure, context)));
+    ObjectHolder MethodCall::Invoke(ObjectHolder object, Closure& closure, Context& context) {
+        auto ptr_class = object.TryAs<runtime::ClassInstance>();
+        runtime::Arguments args(args_.size());
+        EvaluateArguments(args_, first_borrowed_arg_, args, closure, context);
+
+        const runtime::Method* method = ptr_class ? ptr_class->FindMethod(method_, args_.size()) : nullptr;
+        if (!method) throw runtime_error("Method not found"s);
+        return ptr_class->CallMethod(*method, args, context);
+    }
+
+    ObjectHolder MethodCall::Call(const ObjectHolder& object, const std::string& method,
+        std::span<const ObjectHolder> args, Context& context) {
+        auto ptr_class = object.TryAs<runtime::ClassInstance>();
+        const runtime::Method* found = ptr_class ? ptr_class->FindMethod(method, args.size()) : nullptr;
+        if (!found) throw runtime_error("Method not found"s);
+        return ptr_class->CallMethod(*found, args, context);
+    }
+
+    void MethodCall::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(object_);
+        for (auto& arg : args_) {
+            visitor(arg);
         }
+        first_borrowed_arg_ = FirstBorrowedArgument(args_);
+    }
 
-        return ptr_class->Call(method_, args, context);
+    bool MethodCall::IsSelfCall() const {
+        const auto* variable = dynamic_cast<const VariableValue*>(object_.get());
+        return variable && variable->GetDottedIds().size() == 1 && variable->GetDottedIds().front() == "self"sv;
     }
 
     ObjectHolder Stringify::Execute(Closure& closure, Context& context) {
-        auto object = argument_->Execute(closure, context);
-        if (!object) return ObjectHolder::Own(runtime::String{ "None" });
+        return runtime::ToString(argument_->Evaluate(closure, context), context);
+    }
+
+    void UnaryOperation::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(argument_);
+    }
+
+    BinaryOperation::BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
+        : lhs_(move(lhs)), rhs_(move(rhs))
+        , lhs_temporary_(dynamic_cast<ArithmeticOperation*>(lhs_.get()))
+        , rhs_temporary_(dynamic_cast<ArithmeticOperation*>(rhs_.get())) {}
+
+    ObjectHolder BinaryOperation::Temporaries::Materialize(ObjectHolder value) const {
+        if (value.Get() == &lhs || value.Get() == &rhs) {
+            return ObjectHolder::Own(runtime::Number{ value.TryAs<runtime::Number>()->GetValue() });
+        }
+        return value;
+    }
 
-        runtime::DummyContext context_dummy;
-        object->Print(context_dummy.GetOutputStream(), context_dummy);
+    std::pair<ObjectHolder, ObjectHolder> BinaryOperation::EvaluateOperands(Closure& closure, Context& context,
+        Temporaries& temporaries) {
+        //   lhs   ,   rhs    
+        ObjectHolder lhs = lhs_temporary_ ? lhs_temporary_->Compute(closure, context, &temporaries.lhs)
+            : rhs_->IsPure() ? lhs_->Evaluate(closure, context) : lhs_->Execute(closure, context);
+        ObjectHolder rhs = rhs_temporary_ ? rhs_temporary_->Compute(closure, context, &temporaries.rhs)
+            : rhs_->Evaluate(closure, context);
+        return { std::move(lhs), std::move(rhs) };
+    }
+
+    void BinaryOperation::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(lhs_);
+        visitor(rhs_);
+        lhs_temporary_ = dynamic_cast<ArithmeticOperation*>(lhs_.get());
+        rhs_temporary_ = dynamic_cast<ArithmeticOperation*>(rhs_.get());
+    }
 
-        return ObjectHolder::Own(runtime::String{ context_dummy.output.str() });
+    ObjectHolder ArithmeticOperation::MakeNumber(std::int64_t value, runtime::Number* temporary) {
+        if (!temporary) return ObjectHolder::Own(runtime::Number{ value });
+        temporary->SetValue(value);
+        return ObjectHolder::Borrow(*temporary);
     }
 
-    ObjectHolder Add::Execute(Closure& closure, Context& context) {
-        ObjectHolder lhs = lhs_->Execute(closure, context);
-        ObjectHolder rhs = rhs_->Execute(closure, context);
+    ObjectHolder Add::Compute(Closure& closure, Context& context, runtime::Number* temporary) {
+        Temporaries temporaries;
+        auto [lhs, rhs] = EvaluateOperands(closure, context, temporaries);
+
+        auto val_lhs = lhs.TryAs<runtime::Number>();
+        auto val_rhs = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; val_lhs && val_rhs && !runtime::AddOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return MakeNumber(result, temporary);
+        }
+        //  __add__    self,   lhs,    rhs
+        if (lhs.TryAs<runtime::ClassInstance>()) {
+            lhs.Pin();
+            rhs = temporaries.Materialize(std::move(rhs));
+        }
+        return Apply(lhs, rhs, context);
+    }
 
+    ObjectHolder Add::Apply(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context) {
         auto val_lhs = lhs.TryAs<runtime::Number>();
         auto val_rhs = rhs.TryAs<runtime::Number>();
-        if (val_lhs && val_rhs) return ObjectHolder::Own(runtime::Number{ val_lhs->GetValue() + val_rhs->GetValue() });
+        if (std::int64_t result; val_lhs && val_rhs && !runtime::AddOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return ObjectHolder::Own(runtime::Number{ result });
+        }
+        if (auto result = runtime::AddIntegers(lhs, rhs)) return result;
 
         auto val_lhs_str = lhs.TryAs<runtime::String>();
         auto val_rhs_str = rhs.TryAs<runtime::String>();
-        if (val_lhs_str && val_rhs_str) return ObjectHolder::Own(runtime::String{ val_lhs_str->GetValue() + val_rhs_str->GetValue() });
+        if (val_lhs_str && val_rhs_str) return ObjectHolder::Own(runtime::String::Concat(*val_lhs_str, *val_rhs_str));
 
         auto val = lhs.TryAs< runtime::ClassInstance>();
-        if (val && val->HasMethod(ADD_METHOD, 1)) return val->Call(ADD_METHOD, { rhs }, context);
+        if (const runtime::Method* method = val ? val->FindMethod(ADD_METHOD, 1) : nullptr) {
+            return val->CallMethod(*method, std::span(&rhs, 1), context);
+        }
 
         throw runtime_error("Incorrect data types!");
     }
 
-    ObjectHolder Sub::Execute(Closure& closure, Context& context) {
-        ObjectHolder lhs = lhs_->Execute(closure, context);
-        ObjectHolder rhs = rhs_->Execute(closure, context);
+    ObjectHolder Sub::Compute(Closure& closure, Context& context, runtime::Number* temporary) {
+        Temporaries temporaries;
+        auto [lhs, rhs] = EvaluateOperands(closure, context, temporaries);
 
         auto val_lhs = lhs.TryAs<runtime::Number>();
         auto val_rhs = rhs.TryAs<runtime::Number>();
-        if (val_lhs && val_rhs) return ObjectHolder::Own(runtime::Number{ val_lhs->GetValue() - val_rhs->GetValue() });
+        if (std::int64_t result; val_lhs && val_rhs && !runtime::SubOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return MakeNumber(result, temporary);
+        }
+        return Apply(lhs, rhs, context);
+    }
+
+    ObjectHolder Sub::Apply(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& /*context*/) {
+        auto val_lhs = lhs.TryAs<runtime::Number>();
+        auto val_rhs = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; val_lhs && val_rhs && !runtime::SubOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return ObjectHolder::Own(runtime::Number{ result });
+        }
+        if (auto result = runtime::SubtractIntegers(lhs, rhs)) return result;
 
         throw runtime_error("Incorrect data types for subtraction!");
     }
 
-    ObjectHolder Mult::Execute(Closure& closure, Context& context) {
-        ObjectHolder lhs = lhs_->Execute(closure, context);
-        ObjectHolder rhs = rhs_->Execute(closure, context);
+    ObjectHolder Mult::Compute(Closure& closure, Context& context, runtime::Number* temporary) {
+        Temporaries temporaries;
+        auto [lhs, rhs] = EvaluateOperands(closure, context, temporaries);
 
         auto val_lhs = lhs.TryAs<runtime::Number>();
         auto val_rhs = rhs.TryAs<runtime::Number>();
-        if (val_lhs && val_rhs) return ObjectHolder::Own(runtime::Number{ val_lhs->GetValue() * val_rhs->GetValue() });
+        if (std::int64_t result; val_lhs && val_rhs && !runtime::MulOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return MakeNumber(result, temporary);
+        }
+        return Apply(lhs, rhs, context);
+    }
+
+    ObjectHolder Mult::Apply(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& /*context*/) {
+        auto val_lhs = lhs.TryAs<runtime::Number>();
+        auto val_rhs = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; val_lhs && val_rhs && !runtime::MulOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return ObjectHolder::Own(runtime::Number{ result });
+        }
+        if (auto result = runtime::MultiplyIntegers(lhs, rhs)) return result;
 
         throw runtime_error("Incorrect data types for multiplication!");
     }
 
-    ObjectHolder Div::Execute(Closure& closure, Context& context) {
-        ObjectHolder lhs = lhs_->Execute(closure, context);
-        ObjectHolder rhs = rhs_->Execute(closure, context);
+    ObjectHolder Div::Compute(Closure& closure, Context& context, runtime::Number* temporary) {
+        Temporaries temporaries;
+        auto [lhs, rhs] = EvaluateOperands(closure, context, temporaries);
 
+        auto val_lhs = lhs.TryAs<runtime::Number>();
+        auto val_rhs = rhs.TryAs<runtime::Number>();
+        if (std::int64_t result; val_lhs && val_rhs && val_rhs->GetValue() != 0
+            && !runtime::DivOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+            return MakeNumber(result, temporary);
+        }
+        return Apply(lhs, rhs, context);
+    }
+
+    ObjectHolder Div::Apply(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& /*context*/) {
         auto val_lhs = lhs.TryAs<runtime::Number>();
         auto val_rhs = rhs.TryAs<runtime::Number>();
         if (val_lhs && val_rhs) {
             if (val_rhs->GetValue() == 0) throw runtime_error("You can't divide by zero!");
-            return ObjectHolder::Own(runtime::Number{ val_lhs->GetValue() / val_rhs->GetValue() });
+            if (std::int64_t result; !runtime::DivOverflow(val_lhs->GetValue(), val_rhs->GetValue(), result)) {
+                return ObjectHolder::Own(runtime::Number{ result });
+            }
         }
+        if (auto result = runtime::DivideIntegers(lhs, rhs)) return result;
         throw runtime_error("Incorrect data types for division!");
     }
 
+    namespace {
+
+        //   .  Mython   :  return  
+        //     MethodBody,  break  continue -   
+        class ControlMarker : public runtime::Object {
+        public:
+            void Print(std::ostream& /*os*/, Context& /*context*/) override {
+            }
+        };
+
+        ControlMarker return_marker;
+        ControlMarker tail_call_marker;
+        ControlMarker break_marker;
+        ControlMarker continue_marker;
+
+        bool IsControlMarker(const ObjectHolder& result) noexcept {
+            const runtime::Object* object = result.Get();
+            return object == &return_marker || object == &tail_call_marker || object == &break_marker
+                || object == &continue_marker;
+        }
+
+        //  ,     .    TailCall 
+        //   MethodBody     ,   
+        // (. runtime::StepBudget)     
+        thread_local MethodBody* tail_call_body = nullptr;
+
+    }  // namespace
+
     ObjectHolder Compound::Execute(Closure& closure, Context& context) {
         for (const auto& stmt : statements_) {
-            stmt->Execute(closure, context);
+            runtime::StepBudget::Step();
+            if (auto result = stmt->Execute(closure, context); IsControlMarker(result)) {
+                return result;
+            }
         }
         return {};
     }
 
-    ReturnException::ReturnException(const runtime::ObjectHolder& object)
-        : object_(object) {}
+    void Compound::VisitChildren(const runtime::ChildVisitor& visitor) {
+        for (auto& statement : statements_) {
+            visitor(statement);
+        }
+    }
+
+    ReturnException::ReturnException(runtime::ObjectHolder object)
+        : object_(move(object)) {}
 
-    runtime::ObjectHolder ReturnException::GetValue() {
-        return object_;
+    runtime::ObjectHolder ReturnException::TakeValue() noexcept {
+        return move(object_);
     }
 
     ObjectHolder Return::Execute(Closure& closure, Context& context) {
-        auto object = statement_->Execute(closure, context);
-        throw ReturnException(object);
+        return Deliver(statement_->Execute(closure, context), context);
+    }
+
+    void Return::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(statement_);
+    }
+
+    ObjectHolder Return::Deliver(ObjectHolder value, Context& context) {
+        //         MethodBody  
+        if (runtime::CallStack* stack = context.GetCallStack(); stack && stack->GetDepth() > 0) {
+            stack->SetReturnValue(std::move(value));
+            return ObjectHolder::Share(return_marker);
+        }
+        throw ReturnException(std::move(value));
+    }
+
+
+    TailCall::TailCall(std::unique_ptr<MethodCall> call)
+        : call_(move(call)) {}
+
+    bool TailCall::IsPending(const ObjectHolder& result) noexcept {
+        return result.Get() == &tail_call_marker;
+    }
+
+    ObjectHolder TailCall::Execute(Closure& closure, Context& context) {
+        call_->Count();
+        ObjectHolder self = call_->object_->Execute(closure, context);
+
+        //     ,   MethodCall::Invoke.    
+        //   ,      
+        const size_t argument_count = call_->args_.size();
+        runtime::Arguments args(argument_count);
+        for (size_t i = 0; i < argument_count; ++i) {
+            args[i] = call_->args_[i]->Execute(closure, context);
+        }
+
+        auto* instance = self.TryAs<runtime::ClassInstance>();
+        const runtime::Method* found = instance ? instance->FindMethod(call_->method_, argument_count) : nullptr;
+        if (!found) {
+            throw runtime_error("Method not found"s);
+        }
+        const runtime::Method& method = *found;
+        auto* body = dynamic_cast<MethodBody*>(method.body.get());
+        if (!body) {
+            throw ReturnException(instance->CallMethod(method, args, context));
+        }
+
+        //    self  ,    
+        const auto& params = method.formal_params;
+        for (auto it = closure.begin(); it != closure.end();) {
+            if (it->first == runtime::SELF_NAME || std::find(params.begin(), params.end(), it->first) != params.end()) {
+                ++it;
+            }
+            else {
+                it = closure.erase(it);
+            }
+        }
+        closure[runtime::SELF_NAME] = std::move(self);
+        for (size_t i = 0; i < argument_count; ++i) {
+            closure[params[i]] = std::move(args[i]);
+        }
+
+        tail_call_body = body;
+        return ObjectHolder::Share(tail_call_marker);
+    }
+
+    void TailCall::VisitChildren(const runtime::ChildVisitor& visitor) {
+        call_->VisitChildren(visitor);
+    }
+
+    While::While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body)
+        : condition_(move(condition)), body_(move(body)) {}
+
+    ObjectHolder While::Execute(Closure& closure, Context& context) {
+        while (condition_->EvaluateCondition(closure, context)) {
+            runtime::StepBudget::Step();
+            auto result = body_->Execute(closure, context);
+            if (result.Get() == &break_marker) break;
+            if (IsControlMarker(result) && result.Get() != &continue_marker) return result;
+        }
+        return {};
+    }
+
+    void While::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(condition_);
+        visitor(body_);
+    }
+
+    ForRange::ForRange(std::string var, std::unique_ptr<Statement> begin, std::unique_ptr<Statement> end,
+        std::unique_ptr<Statement> body)
+        : var_(move(var)), begin_(move(begin)), end_(move(end)), body_(move(body)) {}
+
+    ObjectHolder ForRange::Execute(Closure& closure, Context& context) {
+        auto bound = [&](Statement& statement) {
+            auto value = statement.Evaluate(closure, context);
+            if (const auto* number = value.TryAs<runtime::Number>()) return number->GetValue();
+            throw runtime_error("range() arguments must be integers"s);
+        };
+        const std::int64_t begin = bound(*begin_);
+        const std::int64_t end = bound(*end_);
+        if (begin >= end) return {};
+
+        //   closure    ,    
+        // ,          
+        ObjectHolder& counter = closure[var_];
+        for (std::int64_t i = begin; i < end; ++i) {
+            runtime::StepBudget::Step();
+            auto* number = counter.IsUnique() ? counter.TryAs<runtime::Number>() : nullptr;
+            if (number) {
+                number->SetValue(i);
+            }
+            else {
+                counter = ObjectHolder::Own(runtime::Number{ i });
+            }
+
+            auto result = body_->Execute(closure, context);
+            if (result.Get() == &break_marker) break;
+            if (IsControlMarker(result) && result.Get() != &continue_marker) return result;
+        }
+        return {};
+    }
+
+    void ForRange::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(begin_);
+        visitor(end_);
+        visitor(body_);
+    }
+
+    ObjectHolder Break::Execute(Closure& /*closure*/, Context& /*context*/) {
+        return ObjectHolder::Share(break_marker);
+    }
+
+    ObjectHolder Continue::Execute(Closure& /*closure*/, Context& /*context*/) {
+        return ObjectHolder::Share(continue_marker);
     }
 
     ClassDefinition::ClassDefinition(ObjectHolder cls)
         : class_(move(cls)) {}
 
     ObjectHolder ClassDefinition::Execute(Closure& closure, Context& /*context*/) {
-        closure[class_.TryAs<runtime::Class>()->GetName()] = std::move(class_);
+        closure[class_.TryAs<runtime::Class>()->GetName()] = class_;
         return {};
     }
 
+    void ClassDefinition::VisitChildren(const runtime::ChildVisitor& visitor) {
+        for (auto& method : class_.TryAs<runtime::Class>()->methods_) {
+            visitor(method.body);
+        }
+    }
+
     FieldAssignment::FieldAssignment(VariableValue object, std::string field_name,
         std::unique_ptr<Statement> rv)
         : object_(move(object)), field_name_(move(field_name)), rv_(move(rv)) {}
 
     ObjectHolder FieldAssignment::Execute(Closure& closure, Context& context) {
-        auto ptr_class = object_.Execute(closure, context).TryAs<runtime::ClassInstance>();
-        ptr_class->Fields()[field_name_] = std::move(rv_->Execute(closure, context));
+        //     rv,     
+        auto object = rv_->IsPure() ? object_.Evaluate(closure, context) : object_.Execute(closure, context);
+        auto ptr_class = object.TryAs<runtime::ClassInstance>();
+        auto [it, inserted] = ptr_class->Fields().insert_or_assign(field_name_, rv_->Execute(closure, context));
+        runtime::Heap::WriteBarrier(*ptr_class);
+
+        return it->second;
+    }
 
-        return ptr_class->Fields()[field_name_];
+    void FieldAssignment::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(rv_);
     }
 
     IfElse::IfElse(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> if_body,
@@ -195,7 +542,7 @@ namespace ast {
         : condition_(move(condition)), if_body_(move(if_body)), else_body_(move(else_body)) {}
 
     ObjectHolder IfElse::Execute(Closure& closure, Context& context) {
-        if (runtime::IsTrue(condition_->Execute(closure, context))) {
+        if (condition_->EvaluateCondition(closure, context)) {
             return if_body_->Execute(closure, context);
         }
         else {
@@ -204,63 +551,128 @@ namespace ast {
         }
     }
 
+    void IfElse::VisitChildren(const runtime::ChildVisitor& visitor) {
+        visitor(condition_);
+        visitor(if_body_);
+        if (else_body_) {
+            visitor(else_body_);
+        }
+    }
+
     ObjectHolder Or::Execute(Closure& closure, Context& context) {
-        auto lhs = lhs_->Execute(closure, context);
-        auto rhs = rhs_->Execute(closure, context);
+        return MakeBool(EvaluateCondition(closure, context));
+    }
 
-        if (runtime::IsTrue(lhs)) return ObjectHolder::Own(runtime::Bool{ true });
-        return ObjectHolder::Own(runtime::Bool{ runtime::IsTrue(rhs) });
+    bool Or::EvaluateCondition(Closure& closure, Context& context) {
+        return lhs_->EvaluateCondition(closure, context) || rhs_->EvaluateCondition(closure, context);
     }
 
     ObjectHolder And::Execute(Closure& closure, Context& context) {
-        auto lhs = lhs_->Execute(closure, context);
-        auto rhs = rhs_->Execute(closure, context);
+        return MakeBool(EvaluateCondition(closure, context));
+    }
 
-        if (!runtime::IsTrue(lhs)) return ObjectHolder::Own(runtime::Bool{ false });
-        return ObjectHolder::Own(runtime::Bool{ runtime::IsTrue(lhs) && runtime::IsTrue(rhs) });
+    bool And::EvaluateCondition(Closure& closure, Context& context) {
+        return lhs_->EvaluateCondition(closure, context) && rhs_->EvaluateCondition(closure, context);
     }
 
     ObjectHolder Not::Execute(Closure& closure, Context& context) {
-        auto value = argument_->Execute(closure, context);
-        return ObjectHolder::Own(runtime::Bool{ !runtime::IsTrue(value) });
+        return MakeBool(EvaluateCondition(closure, context));
+    }
+
+    bool Not::EvaluateCondition(Closure& closure, Context& context) {
+        return !argument_->EvaluateCondition(closure, context);
     }
 
     Comparison::Comparison(Comparator cmp, unique_ptr<Statement> lhs, unique_ptr<Statement> rhs)
         : BinaryOperation(std::move(lhs), std::move(rhs)), cmp_(move(cmp)) {}
 
     ObjectHolder Comparison::Execute(Closure& closure, Context& context) {
-        auto lhs = lhs_->Execute(closure, context);
-        auto rhs = rhs_->Execute(closure, context);
+        return MakeBool(EvaluateCondition(closure, context));
+    }
 
-        return ObjectHolder::Own(runtime::Bool{ cmp_(lhs, rhs, context) });
+    bool Comparison::EvaluateCondition(Closure& closure, Context& context) {
+        Temporaries temporaries;
+        auto [lhs, rhs] = EvaluateOperands(closure, context, temporaries);
+        //     ,     (. runtime::Greater).
+        //     
+        if (lhs.TryAs<runtime::ClassInstance>()) {
+            lhs.Pin();
+            rhs = temporaries.Materialize(std::move(rhs));
+            rhs.Pin();
+        }
+
+        return cmp_(lhs, rhs, context);
     }
 
     NewInstance::NewInstance(const runtime::Class& cls, std::vector<std::unique_ptr<Statement>> args)
-        : class_(cls), args_(move(args)) {}
+        : class_(cls), args_(move(args)), first_borrowed_arg_(FirstBorrowedArgument(args_)) {}
 
     NewInstance::NewInstance(const runtime::Class& cls)
-        : class_(cls) {}
+        : class_(cls), first_borrowed_arg_(0) {}
 
     ObjectHolder NewInstance::Execute(Closure& closure, Context& context) {
-        vector<runtime::ObjectHolder> args;
-        for (const auto& arg : args_) {
-            args.push_back(move(arg->Execute(closure, context)));
+        runtime::Arguments args(args_.size());
+        EvaluateArguments(args_, first_borrowed_arg_, args, closure, context);
+        return Create(class_, args, context);
+    }
+
+    ObjectHolder NewInstance::Create(const runtime::Class& cls, std::span<const ObjectHolder> args, Context& context) {
+        auto instance = ObjectHolder::Own(runtime::ClassInstance{ cls });
+        auto& object = *instance.TryAs<runtime::ClassInstance>();
+        if (const runtime::Method* init = object.FindMethod(INIT_METHOD, args.size())) {
+            object.CallMethod(*init, args, context);
         }
-        if (class_.HasMethod(INIT_METHOD, args_.size())) class_.Call(INIT_METHOD, move(args), context);
-        return runtime::ObjectHolder::Share(class_);
+        return instance;
+    }
+
+    void NewInstance::VisitChildren(const runtime::ChildVisitor& visitor) {
+        for (auto& arg : args_) {
+            visitor(arg);
+        }
+        first_borrowed_arg_ = FirstBorrowedArgument(args_);
     }
 
     MethodBody::MethodBody(std::unique_ptr<Statement>&& body)
-        : body_(move(body)) {}
+        : MethodBody(move(body), false) {}
+
+    MethodBody::MethodBody(std::unique_ptr<Statement>&& body, bool tiered)
+        : body_(move(body)), active_(body_.get()), tiered_(tiered) {}
+
+    std::unique_ptr<Statement> MethodBody::TakeBody() noexcept {
+        active_.store(nullptr, std::memory_order_relaxed);
+        return std::move(body_);
+    }
 
     ObjectHolder MethodBody::Execute(Closure& closure, Context& context) {
-        try {
-            body_->Execute(closure, context);
+        MethodBody* method = this;
+        for (;;) {
+            runtime::StepBudget::Step();
+            Statement* body = method->body_.get();
+            if (method->tiered_) {
+                method->Enter();
+                body = method->active_.load(std::memory_order_acquire);
+            }
+            ObjectHolder result;
+            try {
+                result = body->Execute(closure, context);
+            }
+            catch (ReturnException& object) {
+                return object.TakeValue();
+            }
+            if (result.Get() == &return_marker) {
+                return context.GetCallStack()->TakeReturnValue();
+            }
+            if (!TailCall::IsPending(result)) {
+                return {};
+            }
+            method = tail_call_body;
         }
-        catch (ReturnException& object) {
-            return object.GetValue();
-        }
-        return {};
+    }
+
+    void MethodBody::VisitChildren(const runtime::ChildVisitor& visitor) {
+        //         
+        visitor(body_);
+        active_.store(body_.get(), std::memory_order_relaxed);
     }
 
 }  // namespace ast
\ No newline at end of file
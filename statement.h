@@ -2,7 +2,10 @@
 
 #include "runtime.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <span>
 #include <utility>
 
 namespace ast {
@@ -15,7 +18,8 @@ namespace ast {
     class ValueStatement : public Statement {
     public:
         explicit ValueStatement(T v)
-            : value_(std::move(v)) {
+            : value_(std::move(v))
+            , is_true_(runtime::IsTrue(runtime::ObjectHolder::Share(value_))) {
         }
 
         runtime::ObjectHolder Execute(runtime::Closure& /*closure*/,
@@ -23,11 +27,25 @@ namespace ast {
             return runtime::ObjectHolder::Share(value_);
         }
 
+        bool EvaluateCondition(runtime::Closure& /*closure*/, runtime::Context& /*context*/) override {
+            return is_true_;
+        }
+
+        [[nodiscard]] const T& GetValue() const noexcept {
+            return value_;
+        }
+
+        [[nodiscard]] bool IsPure() const noexcept override {
+            return true;
+        }
+
     private:
         T value_;
+        bool is_true_;
     };
 
     using NumericConst = ValueStatement<runtime::Number>;
+    using BigNumericConst = ValueStatement<runtime::BigNumber>;
     using StringConst = ValueStatement<runtime::String>;
     using BoolConst = ValueStatement<runtime::Bool>;
 
@@ -42,8 +60,21 @@ namespace ast {
         explicit VariableValue(std::vector<std::string> dotted_ids);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        //          
+        runtime::ObjectHolder Evaluate(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] bool IsPure() const noexcept override {
+            return true;
+        }
+
+        [[nodiscard]] const std::vector<std::string>& GetDottedIds() const noexcept {
+            return dotted_ids_;
+        }
 
     private:
+        //  ,   closure    
+        const runtime::ObjectHolder& Find(runtime::Closure& closure) const;
+
         std::vector<std::string> dotted_ids_;
     };
 
@@ -53,6 +84,15 @@ namespace ast {
         Assignment(std::string var, std::unique_ptr<Statement> rv);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const std::string& GetName() const noexcept {
+            return var_;
+        }
+
+        [[nodiscard]] const Statement& GetValue() const noexcept {
+            return *rv_;
+        }
 
     private:
         std::string var_;
@@ -65,6 +105,19 @@ namespace ast {
         FieldAssignment(VariableValue object, std::string field_name, std::unique_ptr<Statement> rv);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const VariableValue& GetObject() const noexcept {
+            return object_;
+        }
+
+        [[nodiscard]] const std::string& GetFieldName() const noexcept {
+            return field_name_;
+        }
+
+        [[nodiscard]] const Statement& GetValue() const noexcept {
+            return *rv_;
+        }
 
     private:
         VariableValue object_;
@@ -79,6 +132,10 @@ namespace ast {
             [[maybe_unused]] runtime::Context& context) override {
             return {};
         }
+
+        [[nodiscard]] bool IsPure() const noexcept override {
+            return true;
+        }
     };
 
     //  print
@@ -92,9 +149,14 @@ namespace ast {
         //   print     name
         static std::unique_ptr<Print> Variable(const std::string& name);
 
-        //     print     ,  
-        // context.GetOutputStream()
+        //     print    ,  
+        // context.GetOutput()
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArguments() const noexcept {
+            return args_;
+        }
 
     private:
         std::vector<std::unique_ptr<Statement>> args_;
@@ -107,11 +169,74 @@ namespace ast {
             std::vector<std::unique_ptr<Statement>> args);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        //  true    self.method(args)
+        [[nodiscard]] bool IsSelfCall() const;
+
+        [[nodiscard]] const std::string& GetMethodName() const noexcept {
+            return method_;
+        }
+
+        [[nodiscard]] size_t GetArgumentCount() const noexcept {
+            return args_.size();
+        }
+
+        [[nodiscard]] const Statement& GetObject() const noexcept {
+            return *object_;
+        }
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArguments() const noexcept {
+            return args_;
+        }
+
+        //   method  object    args.    
+        //     ,  runtime_error
+        static runtime::ObjectHolder Call(const runtime::ObjectHolder& object, const std::string& method,
+            std::span<const runtime::ObjectHolder> args, runtime::Context& context);
+
+        //     .     MAX_COUNTED_CALLS,
+        //         :     
+        [[nodiscard]] std::int64_t GetCalls() const noexcept {
+            return calls_.load(std::memory_order_relaxed);
+        }
+
+        //     .    
+        // (. tiering::TieringManager)     .   
+        //    ,     ,  
+        void EnableCounting() noexcept {
+            counting_ = true;
+        }
+
+        //       (. tiering::TieredMethod)
+        void SetCalls(std::int64_t calls) noexcept {
+            calls_.store(calls, std::memory_order_relaxed);
+        }
+
+        static constexpr std::int64_t MAX_COUNTED_CALLS = 1'000'000;
 
     private:
+        friend class TailCall;
+        friend class InlinedCall;
+
+        //          object
+        runtime::ObjectHolder Invoke(runtime::ObjectHolder object, runtime::Closure& closure, runtime::Context& context);
+
+        //    ,   
+        void Count() noexcept {
+            if (!counting_) return;
+            if (const std::int64_t calls = calls_.load(std::memory_order_relaxed); calls < MAX_COUNTED_CALLS) {
+                calls_.store(calls + 1, std::memory_order_relaxed);
+            }
+        }
+
         std::unique_ptr<Statement> object_;
         std::string method_;
         std::vector<std::unique_ptr<Statement>> args_;
+        // ,   ,   
+        size_t first_borrowed_arg_;
+        bool counting_ = false;
+        std::atomic<std::int64_t> calls_ = 0;
     };
 
     /*
@@ -131,12 +256,26 @@ namespace ast {
     public:
         explicit NewInstance(const runtime::Class& cls);
         NewInstance(const runtime::Class& cls, std::vector<std::unique_ptr<Statement>> args);
-        //  ,    ClassInstance
+        //   ,    ClassInstance
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const runtime::Class& GetClass() const noexcept {
+            return class_;
+        }
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetArguments() const noexcept {
+            return args_;
+        }
+
+        //    cls     __init__   args,   
+        static runtime::ObjectHolder Create(const runtime::Class& cls, std::span<const runtime::ObjectHolder> args,
+            runtime::Context& context);
 
     private:
-        runtime::ClassInstance class_;
+        const runtime::Class& class_;
         std::vector<std::unique_ptr<Statement>> args_;
+        size_t first_borrowed_arg_;
     };
 
     //     
@@ -145,6 +284,17 @@ namespace ast {
         explicit UnaryOperation(std::unique_ptr<Statement> argument)
             : argument_(move(argument)) {}
 
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const Statement& GetArgument() const noexcept {
+            return *argument_;
+        }
+
+        //    ,    
+        [[nodiscard]] std::unique_ptr<Statement> TakeArgument() noexcept {
+            return std::move(argument_);
+        }
+
     protected:
         std::unique_ptr<Statement> argument_;
     };
@@ -156,62 +306,135 @@ namespace ast {
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
     };
 
+    class ArithmeticOperation;
+
     //       lhs  rhs
     class BinaryOperation : public Statement {
     public:
-        BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs)
-            : lhs_(move(lhs)), rhs_(move(rhs)) {}
+        BinaryOperation(std::unique_ptr<Statement> lhs, std::unique_ptr<Statement> rhs);
+
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const Statement& GetLhs() const noexcept {
+            return *lhs_;
+        }
+
+        [[nodiscard]] const Statement& GetRhs() const noexcept {
+            return *rhs_;
+        }
 
     protected:
+        /*
+         *     .   ,
+         *  ,        : 
+         *           .   
+         *     ,    
+         */
+        struct Temporaries {
+            runtime::Number lhs{ 0 };
+            runtime::Number rhs{ 0 };
+
+            //    value,  value    .
+            //       Mython,    
+            [[nodiscard]] runtime::ObjectHolder Materialize(runtime::ObjectHolder value) const;
+        };
+
+        //     . lhs ,    rhs
+        //    .  -    temporaries
+        std::pair<runtime::ObjectHolder, runtime::ObjectHolder> EvaluateOperands(runtime::Closure& closure,
+            runtime::Context& context, Temporaries& temporaries);
+
         std::unique_ptr<Statement> lhs_;
         std::unique_ptr<Statement> rhs_;
+        // ,     Temporaries,  nullptr
+        ArithmeticOperation* lhs_temporary_;
+        ArithmeticOperation* rhs_temporary_;
     };
 
-    //    +   lhs  rhs
-    class Add : public BinaryOperation {
+    //  . Ÿ        
+    //   (. BinaryOperation::Temporaries)
+    class ArithmeticOperation : public BinaryOperation {
     public:
         using BinaryOperation::BinaryOperation;
 
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) final {
+            return Compute(closure, context, nullptr);
+        }
+
+        //   .   temporary,   Number  
+        //     .     
+        virtual runtime::ObjectHolder Compute(runtime::Closure& closure, runtime::Context& context,
+            runtime::Number* temporary) = 0;
+
+    protected:
+        [[nodiscard]] static runtime::ObjectHolder MakeNumber(std::int64_t value, runtime::Number* temporary);
+    };
+
+    //    +   lhs  rhs
+    class Add : public ArithmeticOperation {
+    public:
+        using ArithmeticOperation::ArithmeticOperation;
+
         //  :
         //   + 
         //   + 
         //  1 + 2,   1 -     _add__(rhs)
         //       runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        runtime::ObjectHolder Compute(runtime::Closure& closure, runtime::Context& context,
+            runtime::Number* temporary) override;
+
+        //     .    
+        static runtime::ObjectHolder Apply(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+            runtime::Context& context);
     };
 
     //     lhs  rhs
-    class Sub : public BinaryOperation {
+    class Sub : public ArithmeticOperation {
     public:
-        using BinaryOperation::BinaryOperation;
+        using ArithmeticOperation::ArithmeticOperation;
 
         //  :
         //   - 
         //  lhs  rhs -  ,   runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        runtime::ObjectHolder Compute(runtime::Closure& closure, runtime::Context& context,
+            runtime::Number* temporary) override;
+
+        //     .    
+        static runtime::ObjectHolder Apply(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+            runtime::Context& context);
     };
 
     //     lhs  rhs
-    class Mult : public BinaryOperation {
+    class Mult : public ArithmeticOperation {
     public:
-        using BinaryOperation::BinaryOperation;
+        using ArithmeticOperation::ArithmeticOperation;
 
         //  :
         //   * 
         //  lhs  rhs -  ,   runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        runtime::ObjectHolder Compute(runtime::Closure& closure, runtime::Context& context,
+            runtime::Number* temporary) override;
+
+        //     .    
+        static runtime::ObjectHolder Apply(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+            runtime::Context& context);
     };
 
     //    lhs  rhs
-    class Div : public BinaryOperation {
+    class Div : public ArithmeticOperation {
     public:
-        using BinaryOperation::BinaryOperation;
+        using ArithmeticOperation::ArithmeticOperation;
 
         //  :
         //   / 
         //  lhs  rhs -  ,   runtime_error
         //  rhs  0,   runtime_error
-        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        runtime::ObjectHolder Compute(runtime::Closure& closure, runtime::Context& context,
+            runtime::Number* temporary) override;
+
+        //     .    
+        static runtime::ObjectHolder Apply(const runtime::ObjectHolder& lhs, const runtime::ObjectHolder& rhs,
+            runtime::Context& context);
     };
 
     //      or  lhs  rhs
@@ -221,6 +444,7 @@ namespace ast {
         //   rhs ,    lhs
         //    Bool  False
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
     };
 
     //      and  lhs  rhs
@@ -230,6 +454,7 @@ namespace ast {
         //   rhs ,    lhs
         //    Bool  True
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
     };
 
     //      not    
@@ -237,6 +462,7 @@ namespace ast {
     public:
         using UnaryOperation::UnaryOperation;
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
     };
 
     //   (:  ,   if,  else)
@@ -253,8 +479,14 @@ namespace ast {
             statements_.push_back(std::move(stmt));
         }
 
-        //    .  None
+        //    .  None  
+        //  , break  continue,     (. TailCall)
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Statement>>& GetStatements() const noexcept {
+            return statements_;
+        }
 
     private:
         template<typename T0, typename...Args>
@@ -276,18 +508,48 @@ namespace ast {
 
         //  ,    body.
         //   body    return,   return
-        //     None
+        //     None.
+        //   (. TailCall)     : closure  
+        //  ,     
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        //     ,          
+        [[nodiscard]] const Statement& GetBody() const noexcept {
+            return *body_;
+        }
+
+        //    ,    
+        [[nodiscard]] std::unique_ptr<Statement> TakeBody() noexcept;
+
+    protected:
+        // ,   tiered = true,    ,    
+        //    ,  Enter   ,  SetActiveBody
+        // (. tiering::TieredMethod).    body   
+        MethodBody(std::unique_ptr<Statement>&& body, bool tiered);
+
+        //     ,   tiered = true
+        virtual void Enter() {
+        }
+
+        //  ,     .    
+        //  ,    ,   
+        void SetActiveBody(Statement& body) noexcept {
+            active_.store(&body, std::memory_order_release);
+        }
 
     private:
         std::unique_ptr<Statement>body_;
+        std::atomic<Statement*> active_;
+        bool tiered_ = false;
     };
 
     class ReturnException : public std::exception {
     public:
-        ReturnException(const runtime::ObjectHolder& object);
+        explicit ReturnException(runtime::ObjectHolder object);
 
-        runtime::ObjectHolder GetValue();
+        //     
+        runtime::ObjectHolder TakeValue() noexcept;
 
     private:
         runtime::ObjectHolder object_;
@@ -302,11 +564,123 @@ namespace ast {
         //    .    return ,
         //     ,      statement.
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const Statement& GetStatement() const noexcept {
+            return *statement_;
+        }
+
+        //  value     ,   return
+        static runtime::ObjectHolder Deliver(runtime::ObjectHolder value, runtime::Context& context);
 
     private:
         std::unique_ptr<Statement> statement_;
     };
 
+    /*
+     *  return self.method(args)   .      
+     *  :     ,  closure  
+     *    method,  Execute    .
+     *     ,    ,  MethodBody
+     *        .    
+     * return self.step(n - 1)         .
+     *      MethodBody,   
+     */
+    class TailCall : public Statement {
+    public:
+        explicit TailCall(std::unique_ptr<MethodCall> call);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        //  true,  result -   
+        [[nodiscard]] static bool IsPending(const runtime::ObjectHolder& result) noexcept;
+
+        [[nodiscard]] const MethodCall& GetCall() const noexcept {
+            return *call_;
+        }
+
+        [[nodiscard]] MethodCall& GetCall() noexcept {
+            return *call_;
+        }
+
+    private:
+        std::unique_ptr<MethodCall> call_;
+    };
+
+    //  while <condition> <body>
+    class While : public Statement {
+    public:
+        While(std::unique_ptr<Statement> condition, std::unique_ptr<Statement> body);
+
+        //  body,  condition .  break  continue  
+        //    .  None    
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const Statement& GetCondition() const noexcept {
+            return *condition_;
+        }
+
+        [[nodiscard]] const Statement& GetBody() const noexcept {
+            return *body_;
+        }
+
+    private:
+        std::unique_ptr<Statement> condition_;
+        std::unique_ptr<Statement> body_;
+    };
+
+    /*
+     *  for <var> in range(<begin>, <end>) <body>.
+     *         ,   Number.
+     *      .   var -   
+     *  Number,   Number   ,     .
+     *  var         
+     */
+    class ForRange : public Statement {
+    public:
+        ForRange(std::string var, std::unique_ptr<Statement> begin, std::unique_ptr<Statement> end,
+            std::unique_ptr<Statement> body);
+
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const std::string& GetVariable() const noexcept {
+            return var_;
+        }
+
+        [[nodiscard]] const Statement& GetBegin() const noexcept {
+            return *begin_;
+        }
+
+        [[nodiscard]] const Statement& GetEnd() const noexcept {
+            return *end_;
+        }
+
+        [[nodiscard]] const Statement& GetBody() const noexcept {
+            return *body_;
+        }
+
+    private:
+        std::string var_;
+        std::unique_ptr<Statement> begin_;
+        std::unique_ptr<Statement> end_;
+        std::unique_ptr<Statement> body_;
+    };
+
+    //  break.  ,   
+    class Break : public Statement {
+    public:
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
+    //  continue.  ,     
+    class Continue : public Statement {
+    public:
+        runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+    };
+
     //  
     class ClassDefinition : public Statement {
     public:
@@ -314,11 +688,21 @@ namespace ast {
         explicit ClassDefinition(runtime::ObjectHolder cls);
 
         //   closure  ,      ,  
-        // 
+        // .         
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const runtime::Class& GetClass() const noexcept {
+            return *class_.TryAs<runtime::Class>();
+        }
+
+        //    ,      
+        [[nodiscard]] runtime::Class& GetClass() noexcept {
+            return *class_.TryAs<runtime::Class>();
+        }
 
     private:
-        runtime::ObjectHolder class_;
+        const runtime::ObjectHolder class_;
     };
 
     //  if <condition> <if_body> else <else_body>
@@ -329,6 +713,20 @@ namespace ast {
             std::unique_ptr<Statement> else_body);
 
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        void VisitChildren(const runtime::ChildVisitor& visitor) override;
+
+        [[nodiscard]] const Statement& GetCondition() const noexcept {
+            return *condition_;
+        }
+
+        [[nodiscard]] const Statement& GetIfBody() const noexcept {
+            return *if_body_;
+        }
+
+        //   else  nullptr
+        [[nodiscard]] const Statement* GetElseBody() const noexcept {
+            return else_body_.get();
+        }
 
     private:
         std::unique_ptr<Statement> condition_;
@@ -348,6 +746,12 @@ namespace ast {
         //    lhs  rhs     comparator,
         //    runtime::Bool
         runtime::ObjectHolder Execute(runtime::Closure& closure, runtime::Context& context) override;
+        //    comparator   Bool
+        bool EvaluateCondition(runtime::Closure& closure, runtime::Context& context) override;
+
+        [[nodiscard]] const Comparator& GetComparator() const noexcept {
+            return cmp_;
+        }
 
     private:
         Comparator cmp_;
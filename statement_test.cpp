@@ -1,6 +1,10 @@
+#include "fusion.h"
+#include "inliner.h"
 #include "statement.h"
 #include "test_runner_p.h"
 
+#include <limits>
+
 using namespace std;
 
 namespace ast {
@@ -453,6 +457,300 @@ namespace ast {
             test_not(false);
         }
 
+        void TestNewInstanceCreatesObjects() {
+            runtime::Class cls("Box"s, {}, nullptr);
+            NewInstance new_instance(cls);
+            Closure closure;
+            runtime::DummyContext context;
+
+            auto first = new_instance.Execute(closure, context);
+            auto second = new_instance.Execute(closure, context);
+            ASSERT(first.TryAs<runtime::ClassInstance>() != nullptr);
+            ASSERT(first.Get() != second.Get());
+
+            first.TryAs<runtime::ClassInstance>()->Fields()["x"s] = ObjectHolder::Own(runtime::Number{ 1 });
+            ASSERT_EQUAL(second.TryAs<runtime::ClassInstance>()->Fields().count("x"s), 0U);
+        }
+
+        void TestClassDefinitionIsReentrant() {
+            auto cls = ObjectHolder::Own(runtime::Class{ "Box"s, {}, nullptr });
+            ClassDefinition definition(cls);
+            runtime::DummyContext context;
+
+            Closure first;
+            Closure second;
+            definition.Execute(first, context);
+            definition.Execute(second, context);
+            ASSERT_EQUAL(first.at("Box"s).Get(), cls.Get());
+            ASSERT_EQUAL(second.at("Box"s).Get(), cls.Get());
+        }
+
+        void TestTailCallReusesFrame() {
+            vector<runtime::Method> methods;
+            vector<unique_ptr<Statement>> args;
+            args.push_back(make_unique<Add>(make_unique<VariableValue>("a"s), make_unique<NumericConst>(1)));
+            methods.push_back({ "first"s, {"a"s},
+                               make_unique<MethodBody>(make_unique<Compound>(
+                                   make_unique<Assignment>("local"s, make_unique<NumericConst>(7)),
+                                   make_unique<TailCall>(make_unique<MethodCall>(
+                                       make_unique<VariableValue>("self"s), "second"s, move(args))),
+                                   make_unique<Print>(make_unique<StringConst>("unreachable"s)))) });
+            methods.push_back({ "second"s, {"b"s},
+                               make_unique<MethodBody>(make_unique<Return>(make_unique<VariableValue>("b"s))) });
+            runtime::Class cls("Chain"s, move(methods), nullptr);
+
+            runtime::DummyContext context;
+            auto instance = ObjectHolder::Own(runtime::ClassInstance{ cls });
+            Closure frame{ {"self"s, instance}, {"a"s, ObjectHolder::Own(runtime::Number{ 41 })} };
+            auto result = cls.GetMethod("first"s)->body->Execute(frame, context);
+
+            ASSERT_EQUAL(result.TryAs<runtime::Number>()->GetValue(), 42);
+            ASSERT(context.output.str().empty());
+            // The caller's frame became the frame of the callee
+            ASSERT_EQUAL(frame.size(), 2U);
+            ASSERT_EQUAL(frame.at("b"s).TryAs<runtime::Number>()->GetValue(), 42);
+        }
+
+        void TestCallSitesCountedOnRequest() {
+            auto tail_call = make_unique<TailCall>(
+                make_unique<MethodCall>(make_unique<VariableValue>("self"s), "one"s, vector<unique_ptr<Statement>>{}));
+            TailCall& tail_site = *tail_call;
+            vector<runtime::Method> methods;
+            methods.push_back({ "one"s, {}, make_unique<MethodBody>(make_unique<Return>(make_unique<NumericConst>(1))) });
+            methods.push_back({ "forward"s, {}, make_unique<MethodBody>(move(tail_call)) });
+            runtime::Class cls("Counted"s, move(methods), nullptr);
+
+            runtime::DummyContext context;
+            Closure closure{ {"o"s, ObjectHolder::Own(runtime::ClassInstance{ cls })} };
+            MethodCall call(make_unique<VariableValue>("o"s), "one"s, {});
+
+            // Without tiering the call sites do not touch their counters
+            call.Execute(closure, context);
+            Closure frame{ {"self"s, closure.at("o"s)} };
+            cls.GetMethod("forward"s)->body->Execute(frame, context);
+            ASSERT_EQUAL(call.GetCalls(), 0);
+            ASSERT_EQUAL(tail_site.GetCall().GetCalls(), 0);
+
+            call.EnableCounting();
+            tail_site.GetCall().EnableCounting();
+            call.Execute(closure, context);
+            call.Execute(closure, context);
+            cls.GetMethod("forward"s)->body->Execute(frame, context);
+            ASSERT_EQUAL(call.GetCalls(), 2);
+            ASSERT_EQUAL(tail_site.GetCall().GetCalls(), 1);
+        }
+
+        void TestInlinedCallCountsCalls() {
+            vector<runtime::Method> methods;
+            auto getter = make_unique<Return>(make_unique<VariableValue>(vector{ "self"s, "x"s }));
+            methods.push_back({ "get_x"s, {}, make_unique<MethodBody>(move(getter)) });
+            runtime::Class cls("Point"s, move(methods), nullptr);
+
+            runtime::DummyContext context;
+            Closure closure{ {"p"s, ObjectHolder::Own(runtime::ClassInstance{ cls })} };
+            closure.at("p"s).TryAs<runtime::ClassInstance>()->Fields()["x"s] = ObjectHolder::Own(runtime::Number{ 5 });
+
+            auto call = make_unique<MethodCall>(make_unique<VariableValue>("p"s), "get_x"s, vector<unique_ptr<Statement>>{});
+            call->EnableCounting();
+            const MethodCall& site = *call;
+            InlinedCall inlined(move(call), { InlinedMethod{ &cls, { "x"s }, nullopt } });
+
+            // The inlined body runs without the call, but the site still counts it
+            ASSERT_EQUAL(inlined.Execute(closure, context).TryAs<runtime::Number>()->GetValue(), 5);
+            ASSERT_EQUAL(inlined.Execute(closure, context).TryAs<runtime::Number>()->GetValue(), 5);
+            ASSERT_EQUAL(site.GetCalls(), 2);
+        }
+
+        void TestForRangeCountsInPlace() {
+            runtime::Heap heap;
+            runtime::HeapScope scope(heap);
+            runtime::DummyContext context;
+            Closure closure;
+
+            ForRange loop("i"s, make_unique<NumericConst>(997), make_unique<NumericConst>(1000),
+                          make_unique<Print>(make_unique<VariableValue>("i"s)));
+            loop.Execute(closure, context);
+
+            ASSERT_EQUAL(context.output.str(), "997\n998\n999\n"s);
+            ASSERT_EQUAL(closure.at("i"s).TryAs<runtime::Number>()->GetValue(), 999);
+            // The counter is a single Number updated on every iteration
+            ASSERT_EQUAL(heap.GetStats().allocated_objects, 1U);
+        }
+
+        // A pure expression that records the reference count of variable x when evaluated
+        class RefCountProbe : public Statement {
+        public:
+            explicit RefCountProbe(uint32_t& ref_count)
+                : ref_count_(ref_count) {
+            }
+
+            ObjectHolder Execute(Closure& closure, runtime::Context& /*context*/) override {
+                ref_count_ = closure.at("x"s).Get()->GetRefCount();
+                return ObjectHolder::Own(runtime::Number{ 1 });
+            }
+
+            [[nodiscard]] bool IsPure() const noexcept override {
+                return true;
+            }
+
+        private:
+            uint32_t& ref_count_;
+        };
+
+        void TestOperandsAreBorrowed() {
+            runtime::DummyContext context;
+            Closure closure{ {"x"s, ObjectHolder::Own(runtime::Number{ 41 })} };
+
+            uint32_t ref_count = 0;
+            Add sum(make_unique<VariableValue>("x"s), make_unique<RefCountProbe>(ref_count));
+            ASSERT_EQUAL(sum.Execute(closure, context).TryAs<runtime::Number>()->GetValue(), 42);
+            // Reading x for the addition did not take a reference
+            ASSERT_EQUAL(ref_count, 1U);
+
+            auto borrowed = VariableValue("x"s).Evaluate(closure, context);
+            ASSERT_EQUAL(closure.at("x"s).Get()->GetRefCount(), 1U);
+            // A copy of a borrowed reference owns the object
+            ObjectHolder copy = borrowed;
+            ASSERT_EQUAL(closure.at("x"s).Get()->GetRefCount(), 2U);
+            borrowed.Pin();
+            ASSERT_EQUAL(closure.at("x"s).Get()->GetRefCount(), 3U);
+        }
+
+        void TestArithmeticTemporariesStayOnStack() {
+            runtime::Heap heap;
+            runtime::HeapScope scope(heap);
+            runtime::DummyContext context;
+            Closure closure{ {"a"s, ObjectHolder::Own(runtime::Number{ 2 })},
+                             {"b"s, ObjectHolder::Own(runtime::Number{ 3 })},
+                             {"c"s, ObjectHolder::Own(runtime::Number{ 10 })},
+                             {"d"s, ObjectHolder::Own(runtime::Number{ 4 })} };
+            const size_t allocated = heap.GetStats().allocated_objects;
+
+            // (a + b) * (c - d) / (a * b) + 1
+            Add expression(make_unique<Div>(make_unique<Mult>(make_unique<Add>(make_unique<VariableValue>("a"s),
+                                                                               make_unique<VariableValue>("b"s)),
+                                                              make_unique<Sub>(make_unique<VariableValue>("c"s),
+                                                                               make_unique<VariableValue>("d"s))),
+                                            make_unique<Mult>(make_unique<VariableValue>("a"s),
+                                                              make_unique<VariableValue>("b"s))),
+                           make_unique<NumericConst>(1));
+            auto result = expression.Execute(closure, context);
+
+            ASSERT_EQUAL(result.TryAs<runtime::Number>()->GetValue(), 6);
+            // Only the final result is allocated
+            ASSERT_EQUAL(heap.GetStats().allocated_objects, allocated + 1);
+        }
+
+        void TestConditionsDoNotAllocate() {
+            runtime::Heap heap;
+            runtime::HeapScope scope(heap);
+            runtime::DummyContext context;
+            Closure closure{ {"a"s, ObjectHolder::Own(runtime::Number{ 3 })},
+                             {"b"s, ObjectHolder::Own(runtime::Number{ 4 })} };
+            const size_t allocated = heap.GetStats().allocated_objects;
+
+            // if a + 1 < 10 and not a == b: print 'yes'
+            IfElse branch(make_unique<And>(make_unique<Comparison>(runtime::Less,
+                                                                   make_unique<Add>(make_unique<VariableValue>("a"s),
+                                                                                    make_unique<NumericConst>(1)),
+                                                                   make_unique<NumericConst>(10)),
+                                           make_unique<Not>(make_unique<Comparison>(runtime::Equal,
+                                                                                    make_unique<VariableValue>("a"s),
+                                                                                    make_unique<VariableValue>("b"s)))),
+                          make_unique<Print>(make_unique<StringConst>("yes"s)), nullptr);
+            branch.Execute(closure, context);
+
+            ASSERT_EQUAL(context.output.str(), "yes\n"s);
+            ASSERT_EQUAL(heap.GetStats().allocated_objects, allocated);
+        }
+
+        void TestLogicalOperationsShortCircuit() {
+            runtime::DummyContext context;
+            Closure closure;
+
+            Or or_statement(make_unique<BoolConst>(true), make_unique<Print>(make_unique<StringConst>("or"s)));
+            ASSERT(runtime::IsTrue(or_statement.Execute(closure, context)));
+            And and_statement(make_unique<BoolConst>(false), make_unique<Print>(make_unique<StringConst>("and"s)));
+            ASSERT(!runtime::IsTrue(and_statement.Execute(closure, context)));
+            // The right operands were not evaluated
+            ASSERT(context.output.str().empty());
+
+            Or evaluated(make_unique<BoolConst>(false), make_unique<Print>(make_unique<StringConst>("rhs"s)));
+            // print returns its last argument, which is a non-empty string
+            ASSERT(evaluated.EvaluateCondition(closure, context));
+            ASSERT_EQUAL(context.output.str(), "rhs\n"s);
+        }
+
+        void TestFusionRewritesIdioms() {
+            runtime::Heap heap;
+            runtime::HeapScope scope(heap);
+            runtime::Class cls{ "Counter"s, {}, nullptr };
+            runtime::DummyContext context;
+            Closure closure{ {"o"s, ObjectHolder::Own(runtime::ClassInstance{ cls })},
+                             {"i"s, ObjectHolder::Own(runtime::Number{ 0 })} };
+            closure.at("o"s).TryAs<runtime::ClassInstance>()->Fields()["n"s] = ObjectHolder::Own(runtime::Number{ 10 });
+
+            // while i < 3:
+            //   o.n = o.n + 2
+            //   i = i + 1
+            // print str(o.n)
+            auto body = make_unique<Compound>(
+                make_unique<FieldAssignment>(VariableValue{ "o"s }, "n"s,
+                                             make_unique<Add>(make_unique<VariableValue>(vector{ "o"s, "n"s }),
+                                                              make_unique<NumericConst>(2))),
+                make_unique<Assignment>("i"s, make_unique<Add>(make_unique<VariableValue>("i"s),
+                                                               make_unique<NumericConst>(1))));
+            unique_ptr<Statement> program = make_unique<Compound>(
+                make_unique<While>(make_unique<Comparison>(runtime::Less, make_unique<VariableValue>("i"s),
+                                                           make_unique<NumericConst>(3)),
+                                   std::move(body)),
+                make_unique<Print>(make_unique<Stringify>(make_unique<VariableValue>(vector{ "o"s, "n"s }))));
+
+            const FusionStats stats = Fuse(program);
+            ASSERT_EQUAL(stats.GetCount("field_increment"sv), 1U);
+            ASSERT_EQUAL(stats.GetCount("variable_increment"sv), 1U);
+            ASSERT_EQUAL(stats.GetCount("compare_with_constant"sv), 1U);
+            ASSERT_EQUAL(stats.GetCount("print_str"sv), 1U);
+            ASSERT_EQUAL(stats.GetTotal(), 4U);
+
+            const size_t allocated = heap.GetStats().allocated_objects;
+            program->Execute(closure, context);
+            ASSERT_EQUAL(context.output.str(), "16\n"s);
+            // The counters are only referenced by their variables, so they are updated in place
+            ASSERT_EQUAL(heap.GetStats().allocated_objects, allocated);
+        }
+
+        void TestFusedNodesFallBack() {
+            runtime::DummyContext context;
+            constexpr auto max = numeric_limits<int64_t>::max();
+            Closure closure{ {"x"s, ObjectHolder::Own(runtime::Number{ max })} };
+            closure["y"s] = closure.at("x"s);
+
+            unique_ptr<Statement> increment = make_unique<Assignment>(
+                "x"s, make_unique<Add>(make_unique<VariableValue>("x"s), make_unique<NumericConst>(1)));
+            unique_ptr<Statement> compare = make_unique<Comparison>(runtime::Greater, make_unique<VariableValue>("x"s),
+                                                                    make_unique<NumericConst>(max));
+            ASSERT_EQUAL(Fuse(increment).GetCount("variable_increment"sv), 1U);
+            ASSERT_EQUAL(Fuse(compare).GetCount("compare_with_constant"sv), 1U);
+
+            // Passes that walk the tree still reach the operands of the original nodes
+            size_t children = 0;
+            const auto count = [&children](unique_ptr<Statement>&) {
+                ++children;
+            };
+            increment->VisitChildren(count);
+            ASSERT_EQUAL(children, 1U);
+            compare->VisitChildren(count);
+            ASSERT_EQUAL(children, 3U);
+
+            // The overflowing sum is promoted by the original node; y still refers to the old value
+            increment->Execute(closure, context);
+            ASSERT_OBJECT_VALUE_EQUAL(closure.at("x"s), "9223372036854775808"s);
+            ASSERT_EQUAL(closure.at("y"s).TryAs<runtime::Number>()->GetValue(), max);
+            ASSERT(compare->EvaluateCondition(closure, context));
+            ASSERT(runtime::IsTrue(compare->Execute(closure, context)));
+        }
+
     }  // namespace
 
     void RunUnitTests(TestRunner& tr) {
@@ -476,6 +774,18 @@ namespace ast {
         RUN_TEST(tr, ast::TestOr);
         RUN_TEST(tr, ast::TestAnd);
         RUN_TEST(tr, ast::TestNot);
+        RUN_TEST(tr, ast::TestNewInstanceCreatesObjects);
+        RUN_TEST(tr, ast::TestClassDefinitionIsReentrant);
+        RUN_TEST(tr, ast::TestTailCallReusesFrame);
+        RUN_TEST(tr, ast::TestCallSitesCountedOnRequest);
+        RUN_TEST(tr, ast::TestInlinedCallCountsCalls);
+        RUN_TEST(tr, ast::TestForRangeCountsInPlace);
+        RUN_TEST(tr, ast::TestOperandsAreBorrowed);
+        RUN_TEST(tr, ast::TestArithmeticTemporariesStayOnStack);
+        RUN_TEST(tr, ast::TestConditionsDoNotAllocate);
+        RUN_TEST(tr, ast::TestLogicalOperationsShortCircuit);
+        RUN_TEST(tr, ast::TestFusionRewritesIdioms);
+        RUN_TEST(tr, ast::TestFusedNodesFallBack);
     }
 
 }  // namespace ast
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "task.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define MYTHON_ASAN_FIBERS
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MYTHON_ASAN_FIBERS
+#endif
+#endif
+
+#ifdef MYTHON_ASAN_FIBERS
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+using namespace std;
+
+namespace interpreter {
+
+    namespace {
+
+        //          
+        constexpr size_t STACK_RESERVE = 64 * 1024;
+
+    }  // namespace
+
+#ifdef _WIN32
+
+    struct Task::Fiber {
+        void* fiber = nullptr;
+        void* caller = nullptr;
+
+        ~Fiber() {
+            if (fiber) {
+                DeleteFiber(fiber);
+            }
+        }
+
+        static VOID WINAPI Entry(LPVOID task) {
+            static_cast<Task*>(task)->Main();
+        }
+
+        void Create(Task& task, size_t stack_size) {
+            fiber = CreateFiber(stack_size, &Entry, &task);
+            if (!fiber) {
+                throw runtime_error("Failed to create a fiber");
+            }
+        }
+
+        void SwitchIn() {
+            if (!IsThreadAFiber() && !ConvertThreadToFiber(nullptr)) {
+                throw runtime_error("Failed to convert the thread to a fiber");
+            }
+            caller = GetCurrentFiber();
+            SwitchToFiber(fiber);
+        }
+
+        void SwitchOut() noexcept {
+            SwitchToFiber(caller);
+        }
+    };
+
+#else
+
+    namespace {
+
+        // AddressSanitizer      ,    
+        //        
+        void StartSwitch([[maybe_unused]] void** fake_stack, [[maybe_unused]] const void* bottom,
+                         [[maybe_unused]] size_t size) noexcept {
+#ifdef MYTHON_ASAN_FIBERS
+            __sanitizer_start_switch_fiber(fake_stack, bottom, size);
+#endif
+        }
+
+        void FinishSwitch([[maybe_unused]] void* fake_stack, [[maybe_unused]] const void** bottom,
+                          [[maybe_unused]] size_t* size) noexcept {
+#ifdef MYTHON_ASAN_FIBERS
+            __sanitizer_finish_switch_fiber(fake_stack, bottom, size);
+#endif
+        }
+
+    }  // namespace
+
+    struct Task::Fiber {
+        ucontext_t context{};
+        ucontext_t caller{};
+        //  : -      .  
+        //     ,       SIGSEGV,
+        //     
+        void* mapping = nullptr;
+        size_t mapping_size = 0;
+        char* stack = nullptr;
+        size_t stack_size = 0;
+        //  AddressSanitizer   : fake stack    
+        // ,     
+        void* fake_stack = nullptr;
+        void* caller_fake_stack = nullptr;
+        const void* caller_bottom = nullptr;
+        size_t caller_size = 0;
+
+        // makecontext       int,      
+        ~Fiber() {
+            if (mapping) {
+                munmap(mapping, mapping_size);
+            }
+        }
+
+        static void Entry(unsigned low, unsigned high) {
+            const auto address = (static_cast<uintptr_t>(high) << 16 << 16) | low;
+            Task* const task = reinterpret_cast<Task*>(address);
+            Fiber& fiber = *task->fiber_;
+            FinishSwitch(nullptr, &fiber.caller_bottom, &fiber.caller_size);
+            task->Main();
+        }
+
+        void Create(Task& task, size_t size) {
+            const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            stack_size = (size + page - 1) / page * page;
+            mapping_size = stack_size + page;
+            void* memory = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) {
+                throw runtime_error("Failed to allocate a coroutine stack");
+            }
+            mapping = memory;
+            //   ,     
+            if (mprotect(mapping, page, PROT_NONE) != 0) {
+                throw runtime_error("Failed to protect a coroutine stack");
+            }
+            stack = static_cast<char*>(mapping) + page;
+            if (getcontext(&context) != 0) {
+                throw runtime_error("Failed to create a coroutine context");
+            }
+            context.uc_stack.ss_sp = stack;
+            context.uc_stack.ss_size = stack_size;
+            context.uc_link = nullptr;
+            const auto address = reinterpret_cast<uintptr_t>(&task);
+            makecontext(&context, reinterpret_cast<void (*)()>(&Entry), 2, static_cast<unsigned>(address),
+                        static_cast<unsigned>(address >> 16 >> 16));
+        }
+
+        void SwitchIn() {
+            StartSwitch(&caller_fake_stack, stack, stack_size);
+            swapcontext(&caller, &context);
+            FinishSwitch(caller_fake_stack, nullptr, nullptr);
+        }
+
+        void SwitchOut() noexcept {
+            StartSwitch(&fake_stack, caller_bottom, caller_size);
+            swapcontext(&context, &caller);
+            FinishSwitch(fake_stack, &caller_bottom, &caller_size);
+        }
+    };
+
+#endif
+
+    Task::Task(shared_ptr<const Program> program, runtime::OutputSink& output, const Variables& variables,
+               const TaskOptions& options)
+        : program_(move(program))
+        , output_(output)
+        , options_(options)
+        , heap_(options.heap)
+        , context_(output)
+        , fiber_(make_unique<Fiber>()) {
+        options_.slice_steps = max<int64_t>(options_.slice_steps, 1);
+        options_.stack_size = max(options_.stack_size, 4 * STACK_RESERVE);
+        Grant();
+        {
+            runtime::HeapScope heap_scope(heap_);
+            Program::Bind(closure_, variables);
+        }
+        fiber_->Create(*this, options_.stack_size);
+    }
+
+    Task::~Task() {
+        //     ,     
+        if (started_ && !IsDone()) {
+            Cancel();
+            Resume();
+        }
+        runtime::HeapScope heap_scope(heap_);
+        closure_.clear();
+    }
+
+    bool Task::Resume() {
+        if (IsDone()) {
+            return true;
+        }
+        if (cancelled_ && !started_) {
+            state_ = TaskState::CANCELLED;
+            return true;
+        }
+        started_ = true;
+        runtime::HeapScope heap_scope(heap_);
+        StepBudget* const previous = Exchange(this);
+        try {
+            fiber_->SwitchIn();
+        }
+        catch (...) {
+            Exchange(previous);
+            throw;
+        }
+        Exchange(previous);
+        return IsDone();
+    }
+
+    void Task::Grant() noexcept {
+        granted_ = options_.slice_steps;
+        if (options_.step_limit > 0) {
+            granted_ = max<int64_t>(min(granted_, options_.step_limit - steps_), 1);
+        }
+        remaining_ = granted_;
+    }
+
+    void Task::OnExhausted() {
+        if (cancelled_) {
+            throw TaskCancelled();
+        }
+        if (remaining_ > 0) {
+            //   , ,    
+            throw runtime_error("Stack overflow");
+        }
+        steps_ += granted_ - remaining_;
+        granted_ = remaining_;
+        if (options_.step_limit > 0 && steps_ >= options_.step_limit) {
+            throw StepLimitExceeded();
+        }
+        Grant();
+        SwitchToCaller();
+        if (cancelled_) {
+            throw TaskCancelled();
+        }
+    }
+
+    void Task::Main() noexcept {
+        char marker;
+        stack_limit_ = reinterpret_cast<uintptr_t>(&marker) - options_.stack_size + STACK_RESERVE;
+        try {
+            if (cancelled_) {
+                throw TaskCancelled();
+            }
+            program_->Execute(closure_, context_);
+            output_.Flush();
+            state_ = TaskState::FINISHED;
+        }
+        catch (const TaskCancelled&) {
+            state_ = TaskState::CANCELLED;
+        }
+        catch (...) {
+            error_ = current_exception();
+            state_ = TaskState::FAILED;
+        }
+        //   ,     
+        closure_.clear();
+        //     
+        for (;;) {
+            SwitchToCaller();
+        }
+    }
+
+    void Task::SwitchToCaller() noexcept {
+        fiber_->SwitchOut();
+    }
+
+    Task& Scheduler::Spawn(shared_ptr<const Program> program, runtime::OutputSink& output, const Variables& variables,
+                           const TaskOptions& options) {
+        return *tasks_.emplace_back(make_unique<Task>(move(program), output, variables, options));
+    }
+
+    size_t Scheduler::RunOnce() {
+        size_t active = 0;
+        for (const auto& task : tasks_) {
+            if (!task->Resume()) {
+                ++active;
+            }
+        }
+        return active;
+    }
+
+    void Scheduler::Run() {
+        while (RunOnce() > 0) {
+        }
+    }
+
+}  // namespace interpreter
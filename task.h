@@ -0,0 +1,152 @@
+#pragma once
+
+#include "interpreter.h"
+#include "runtime.h"
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace interpreter {
+
+    //      
+    struct TaskOptions {
+        //    (. runtime::StepBudget),     
+        std::int64_t slice_steps = 10'000;
+        //     . 0 -  
+        std::int64_t step_limit = 0;
+        //   .      . 
+        //     
+        size_t stack_size = 1024 * 1024;
+        runtime::HeapOptions heap;
+    };
+
+    //        
+    class TaskCancelled : public std::runtime_error {
+    public:
+        TaskCancelled()
+            : std::runtime_error("Task cancelled") {
+        }
+    };
+
+    //    TaskOptions::step_limit
+    class StepLimitExceeded : public std::runtime_error {
+    public:
+        StepLimitExceeded()
+            : std::runtime_error("Step limit exceeded") {
+        }
+    };
+
+    enum class TaskState {
+        //        
+        SUSPENDED,
+        FINISHED,
+        //   , . GetError()
+        FAILED,
+        CANCELLED,
+    };
+
+    /*
+     *     .     ,
+     *   ,    slice_steps     Resume.
+     *          ,      
+     *   .
+     *
+     *     , Closure  Context. Resume      
+     *  .        :   
+     *    ,       .
+     * Cancel     :    
+     * TaskCancelled,     .    
+     */
+    class Task : private runtime::StepBudget {
+    public:
+        Task(std::shared_ptr<const Program> program, runtime::OutputSink& output, const Variables& variables = {},
+             const TaskOptions& options = {});
+        ~Task();
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        //        .
+        //  true,   
+        bool Resume();
+
+        //  .        Resume
+        void Cancel() noexcept {
+            cancelled_ = true;
+        }
+
+        [[nodiscard]] TaskState GetState() const noexcept {
+            return state_;
+        }
+
+        [[nodiscard]] bool IsDone() const noexcept {
+            return state_ != TaskState::SUSPENDED;
+        }
+
+        //  ,   ,  nullptr
+        [[nodiscard]] std::exception_ptr GetError() const noexcept {
+            return error_;
+        }
+
+        //   ,  
+        [[nodiscard]] std::int64_t GetSteps() const noexcept {
+            return steps_ + granted_ - remaining_;
+        }
+
+    private:
+        struct Fiber;
+
+        void OnExhausted() override;
+        //     
+        void Grant() noexcept;
+        void Main() noexcept;
+        void SwitchToCaller() noexcept;
+
+        std::shared_ptr<const Program> program_;
+        runtime::OutputSink& output_;
+        TaskOptions options_;
+
+        //          
+        runtime::Heap heap_;
+        runtime::SimpleContext context_;
+        runtime::Closure closure_;
+
+        std::unique_ptr<Fiber> fiber_;
+        TaskState state_ = TaskState::SUSPENDED;
+        std::exception_ptr error_;
+        //     
+        std::int64_t steps_ = 0;
+        //   
+        std::int64_t granted_ = 0;
+        bool started_ = false;
+        bool cancelled_ = false;
+    };
+
+    /*
+     *  :         ,
+     *     .     ,  Run
+     */
+    class Scheduler {
+    public:
+        //     
+        Task& Spawn(std::shared_ptr<const Program> program, runtime::OutputSink& output,
+                    const Variables& variables = {}, const TaskOptions& options = {});
+
+        //       .
+        //   ,  
+        size_t RunOnce();
+        //  ,     
+        void Run();
+
+        [[nodiscard]] const std::vector<std::unique_ptr<Task>>& GetTasks() const noexcept {
+            return tasks_;
+        }
+
+    private:
+        std::vector<std::unique_ptr<Task>> tasks_;
+    };
+
+}  // namespace interpreter
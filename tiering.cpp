@@ -0,0 +1,279 @@
+#include "tiering.h"
+
+#include "fusion.h"
+#include "inliner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace tiering {
+
+    namespace {
+
+        // ,    :       
+        constexpr int64_t NEVER = numeric_limits<int64_t>::max();
+
+        // ,   
+        struct Unsupported {};
+
+        unique_ptr<ast::Statement> Copy(const ast::Statement& node);
+
+        vector<unique_ptr<ast::Statement>> CopyAll(const vector<unique_ptr<ast::Statement>>& nodes) {
+            vector<unique_ptr<ast::Statement>> result;
+            result.reserve(nodes.size());
+            for (const auto& node : nodes) {
+                result.push_back(Copy(*node));
+            }
+            return result;
+        }
+
+        unique_ptr<ast::MethodCall> CopyCall(const ast::MethodCall& call) {
+            auto copy = make_unique<ast::MethodCall>(Copy(call.GetObject()), call.GetMethodName(),
+                                                     CopyAll(call.GetArguments()));
+            copy->SetCalls(call.GetCalls());
+            return copy;
+        }
+
+        template <typename Operation>
+        unique_ptr<ast::Statement> CopyBinary(const ast::BinaryOperation& operation) {
+            return make_unique<Operation>(Copy(operation.GetLhs()), Copy(operation.GetRhs()));
+        }
+
+        //      ,     .    , 
+        // ,      ,    
+        unique_ptr<ast::Statement> Copy(const ast::Statement& node) {
+            if (const auto* constant = dynamic_cast<const ast::NumericConst*>(&node)) {
+                return make_unique<ast::NumericConst>(constant->GetValue());
+            }
+            if (const auto* constant = dynamic_cast<const ast::BigNumericConst*>(&node)) {
+                return make_unique<ast::BigNumericConst>(constant->GetValue());
+            }
+            if (const auto* constant = dynamic_cast<const ast::StringConst*>(&node)) {
+                return make_unique<ast::StringConst>(constant->GetValue());
+            }
+            if (const auto* constant = dynamic_cast<const ast::BoolConst*>(&node)) {
+                return make_unique<ast::BoolConst>(constant->GetValue());
+            }
+            if (dynamic_cast<const ast::None*>(&node)) {
+                return make_unique<ast::None>();
+            }
+            if (const auto* variable = dynamic_cast<const ast::VariableValue*>(&node)) {
+                return make_unique<ast::VariableValue>(variable->GetDottedIds());
+            }
+            if (const auto* assignment = dynamic_cast<const ast::Assignment*>(&node)) {
+                return make_unique<ast::Assignment>(assignment->GetName(), Copy(assignment->GetValue()));
+            }
+            if (const auto* assignment = dynamic_cast<const ast::FieldAssignment*>(&node)) {
+                return make_unique<ast::FieldAssignment>(ast::VariableValue(assignment->GetObject().GetDottedIds()),
+                                                         assignment->GetFieldName(), Copy(assignment->GetValue()));
+            }
+            if (const auto* print = dynamic_cast<const ast::Print*>(&node)) {
+                return make_unique<ast::Print>(CopyAll(print->GetArguments()));
+            }
+            if (const auto* call = dynamic_cast<const ast::MethodCall*>(&node)) {
+                return CopyCall(*call);
+            }
+            if (const auto* instance = dynamic_cast<const ast::NewInstance*>(&node)) {
+                return make_unique<ast::NewInstance>(instance->GetClass(), CopyAll(instance->GetArguments()));
+            }
+            if (const auto* stringify = dynamic_cast<const ast::Stringify*>(&node)) {
+                return make_unique<ast::Stringify>(Copy(stringify->GetArgument()));
+            }
+            if (const auto* negation = dynamic_cast<const ast::Not*>(&node)) {
+                return make_unique<ast::Not>(Copy(negation->GetArgument()));
+            }
+            if (const auto* comparison = dynamic_cast<const ast::Comparison*>(&node)) {
+                return make_unique<ast::Comparison>(comparison->GetComparator(), Copy(comparison->GetLhs()),
+                                                    Copy(comparison->GetRhs()));
+            }
+            if (const auto* operation = dynamic_cast<const ast::BinaryOperation*>(&node)) {
+                if (dynamic_cast<const ast::Add*>(&node)) return CopyBinary<ast::Add>(*operation);
+                if (dynamic_cast<const ast::Sub*>(&node)) return CopyBinary<ast::Sub>(*operation);
+                if (dynamic_cast<const ast::Mult*>(&node)) return CopyBinary<ast::Mult>(*operation);
+                if (dynamic_cast<const ast::Div*>(&node)) return CopyBinary<ast::Div>(*operation);
+                if (dynamic_cast<const ast::And*>(&node)) return CopyBinary<ast::And>(*operation);
+                if (dynamic_cast<const ast::Or*>(&node)) return CopyBinary<ast::Or>(*operation);
+                throw Unsupported{};
+            }
+            if (const auto* compound = dynamic_cast<const ast::Compound*>(&node)) {
+                auto copy = make_unique<ast::Compound>();
+                for (const auto& statement : compound->GetStatements()) {
+                    copy->AddStatement(Copy(*statement));
+                }
+                return copy;
+            }
+            if (const auto* ret = dynamic_cast<const ast::Return*>(&node)) {
+                return make_unique<ast::Return>(Copy(ret->GetStatement()));
+            }
+            if (const auto* tail_call = dynamic_cast<const ast::TailCall*>(&node)) {
+                return make_unique<ast::TailCall>(CopyCall(tail_call->GetCall()));
+            }
+            if (const auto* loop = dynamic_cast<const ast::While*>(&node)) {
+                return make_unique<ast::While>(Copy(loop->GetCondition()), Copy(loop->GetBody()));
+            }
+            if (const auto* loop = dynamic_cast<const ast::ForRange*>(&node)) {
+                return make_unique<ast::ForRange>(loop->GetVariable(), Copy(loop->GetBegin()), Copy(loop->GetEnd()),
+                                                  Copy(loop->GetBody()));
+            }
+            if (const auto* branch = dynamic_cast<const ast::IfElse*>(&node)) {
+                return make_unique<ast::IfElse>(Copy(branch->GetCondition()), Copy(branch->GetIfBody()),
+                                                branch->GetElseBody() ? Copy(*branch->GetElseBody()) : nullptr);
+            }
+            if (dynamic_cast<const ast::Break*>(&node)) {
+                return make_unique<ast::Break>();
+            }
+            if (dynamic_cast<const ast::Continue*>(&node)) {
+                return make_unique<ast::Continue>();
+            }
+            throw Unsupported{};
+        }
+
+        //     nullptr,     ,   
+        unique_ptr<ast::Statement> CopyBody(const ast::Statement& body) {
+            try {
+                return Copy(body);
+            }
+            catch (const Unsupported&) {
+                return nullptr;
+            }
+        }
+
+    }  // namespace
+
+    void TierStats::Print(ostream& out) const {
+        out << "tiers: cold "sv << cold << " (uncopyable "sv << uncopyable << "), warm "sv << warm << ", hot "sv << hot
+            << " (compiled "sv << compiled << ")\n"sv;
+    }
+
+    TieredMethod::TieredMethod(vector<string> formal_params, unique_ptr<ast::Statement> body,
+                               const TieringManager& manager)
+        : MethodBody(std::move(body), true)
+        , formal_params_(std::move(formal_params))
+        , manager_(manager)
+        , next_threshold_(min(manager.GetOptions().warm, manager.GetOptions().hot)) {
+    }
+
+    TieredMethod::~TieredMethod() = default;
+
+    bool TieredMethod::TryCall(runtime::ClassInstance& self, span<const runtime::ObjectHolder> args,
+                               runtime::Context& context, runtime::ObjectHolder& result) {
+        jit::JitMethod* compiled = published_.load(memory_order_acquire);
+        return compiled && compiled->TryCall(self, args, context, result);
+    }
+
+    bool TieredMethod::IsCompiled() const noexcept {
+        const jit::JitMethod* compiled = published_.load(memory_order_acquire);
+        return compiled && compiled->IsCompiled();
+    }
+
+    void TieredMethod::Enter() {
+        const int64_t threshold = next_threshold_.load(memory_order_relaxed);
+        if (threshold == NEVER) return;
+        const int64_t calls = calls_.load(memory_order_relaxed) + 1;
+        calls_.store(calls, memory_order_relaxed);
+        if (calls >= threshold) {
+            TierUp(calls);
+        }
+    }
+
+    void TieredMethod::TierUp(int64_t calls) {
+        lock_guard guard(tier_up_mutex_);
+        const TieringOptions& options = manager_.GetOptions();
+        //  HOT   ,      WARM
+        if (GetTier() == Tier::COLD && calls >= min(options.warm, options.hot)) {
+            Optimize();
+        }
+        if (GetTier() == Tier::WARM && calls >= options.hot) {
+            Compile();
+        }
+        // ,     ,    COLD
+        next_threshold_.store(GetTier() == Tier::WARM && calls < options.hot ? options.hot : NEVER, memory_order_relaxed);
+    }
+
+    void TieredMethod::Optimize() {
+        auto body = CopyBody(GetBody());
+        if (!body) {
+            uncopyable_.store(true, memory_order_relaxed);
+            return;
+        }
+        const TieringOptions& options = manager_.GetOptions();
+        //      ,     
+        if (options.inlining) {
+            static_cast<void>(ast::InlineCalls(body, manager_.GetClasses(), 1));
+        }
+        if (options.fusion) {
+            static_cast<void>(ast::Fuse(body));
+        }
+        optimized_ = std::move(body);
+        SetActiveBody(*optimized_);
+        tier_.store(Tier::WARM, memory_order_release);
+    }
+
+    void TieredMethod::Compile() {
+        auto body = CopyBody(GetBody());
+        if (!body) return;
+        auto method = make_unique<ast::MethodBody>(std::move(body));
+        // ,  JIT   ,    WARM
+        if (!jit::CanCompile(formal_params_, *method)) return;
+        //      
+        const jit::JitOptions options{ .threshold = 1, .max_deopts = manager_.GetOptions().max_deopts };
+        compiled_ = make_unique<jit::JitMethod>(formal_params_, std::move(method), options);
+        published_.store(compiled_.get(), memory_order_release);
+        tier_.store(Tier::HOT, memory_order_release);
+    }
+
+    TieringManager::TieringManager(unique_ptr<runtime::Executable>& root, const TieringOptions& options)
+        : options_(options) {
+        if (root) {
+            Enable(*root);
+        }
+    }
+
+    TierStats TieringManager::GetStats() const {
+        TierStats stats;
+        for (const TieredMethod* method : methods_) {
+            switch (method->GetTier()) {
+            case Tier::COLD:
+                ++stats.cold;
+                stats.uncopyable += method->IsUncopyable() ? 1 : 0;
+                break;
+            case Tier::WARM:
+                ++stats.warm;
+                break;
+            case Tier::HOT:
+                ++stats.hot;
+                stats.compiled += method->IsCompiled() ? 1 : 0;
+                break;
+            }
+        }
+        return stats;
+    }
+
+    void TieringManager::Enable(runtime::Executable& node) {
+        if (auto* definition = dynamic_cast<ast::ClassDefinition*>(&node)) {
+            classes_.push_back(&definition->GetClass());
+            for (runtime::Method& method : definition->GetClass().methods_) {
+                // ,    (,   C++),  
+                auto* body = dynamic_cast<ast::MethodBody*>(method.body.get());
+                if (!body) continue;
+                auto tiered = make_unique<TieredMethod>(method.formal_params, body->TakeBody(), *this);
+                methods_.push_back(tiered.get());
+                method.body = std::move(tiered);
+            }
+        }
+        //    :   WARM    
+        if (auto* call = dynamic_cast<ast::MethodCall*>(&node)) {
+            call->EnableCounting();
+        }
+        else if (auto* tail_call = dynamic_cast<ast::TailCall*>(&node)) {
+            tail_call->GetCall().EnableCounting();
+        }
+        node.VisitChildren([this](unique_ptr<runtime::Executable>& child) {
+            Enable(*child);
+        });
+    }
+
+}  // namespace tiering
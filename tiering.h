@@ -0,0 +1,144 @@
+#pragma once
+
+#include "jit.h"
+#include "statement.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tiering {
+
+    //   
+    struct TieringOptions {
+        //   ,       
+        std::int64_t warm = 50;
+        //   ,        
+        std::int64_t hot = 1000;
+        //       ,      
+        std::int64_t max_deopts = 100;
+        // ,        (. ast::InlineCalls, ast::Fuse)
+        bool inlining = true;
+        bool fusion = true;
+    };
+
+    //   
+    enum class Tier {
+        //     
+        COLD,
+        //          
+        WARM,
+        //   JIT. ,     ,   
+        HOT,
+    };
+
+    //     
+    struct TierStats {
+        size_t cold = 0;
+        //   COLD,    ,      
+        size_t uncopyable = 0;
+        size_t warm = 0;
+        size_t hot = 0;
+        //   HOT,    
+        size_t compiled = 0;
+
+        void Print(std::ostream& out) const;
+    };
+
+    class TieringManager;
+
+    /*
+     *  ,     ,      .
+     *       ,      
+     * (. ast::MethodBody::Enter),      -   ,   
+     *    (. ast::MethodCall::GetCalls). 
+     *   WARM           , 
+     *    HOT    JIT.    ,  ,
+     *   ,      ,    ,  
+     *    .    ,   , 
+     *    COLD
+     */
+    class TieredMethod : public ast::MethodBody {
+    public:
+        TieredMethod(std::vector<std::string> formal_params, std::unique_ptr<ast::Statement> body,
+                     const TieringManager& manager);
+        ~TieredMethod() override;
+
+        bool TryCall(runtime::ClassInstance& self, std::span<const runtime::ObjectHolder> args,
+                     runtime::Context& context, runtime::ObjectHolder& result) override;
+
+        [[nodiscard]] Tier GetTier() const noexcept {
+            return tier_.load(std::memory_order_acquire);
+        }
+
+        //  true,     
+        [[nodiscard]] bool IsCompiled() const noexcept;
+
+        //  true,      ,     
+        [[nodiscard]] bool IsUncopyable() const noexcept {
+            return uncopyable_.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        void Enter() override;
+
+    private:
+        //    ,   
+        void TierUp(std::int64_t calls);
+        void Optimize();
+        void Compile();
+
+        std::vector<std::string> formal_params_;
+        const TieringManager& manager_;
+
+        //         .  
+        //     
+        std::atomic<std::int64_t> calls_ = 0;
+        std::atomic<std::int64_t> next_threshold_;
+        std::atomic<Tier> tier_ = Tier::COLD;
+        std::atomic<bool> uncopyable_ = false;
+        std::mutex tier_up_mutex_;
+        std::unique_ptr<ast::Statement> optimized_;
+        std::unique_ptr<jit::JitMethod> compiled_;
+        std::atomic<jit::JitMethod*> published_ = nullptr;
+    };
+
+    /*
+     *    .       
+     *   ,         
+     *          .   
+     *     ,         
+     */
+    class TieringManager {
+    public:
+        //     root  TieredMethod
+        TieringManager(std::unique_ptr<runtime::Executable>& root, const TieringOptions& options);
+
+        TieringManager(const TieringManager&) = delete;
+        TieringManager& operator=(const TieringManager&) = delete;
+
+        [[nodiscard]] const TieringOptions& GetOptions() const noexcept {
+            return options_;
+        }
+
+        //  ,       WARM
+        [[nodiscard]] const std::vector<const runtime::Class*>& GetClasses() const noexcept {
+            return classes_;
+        }
+
+        [[nodiscard]] TierStats GetStats() const;
+
+    private:
+        void Enable(runtime::Executable& node);
+
+        TieringOptions options_;
+        std::vector<const runtime::Class*> classes_;
+        std::vector<const TieredMethod*> methods_;
+    };
+
+}  // namespace tiering
@@ -0,0 +1,561 @@
+#include "transpiler.h"
+
+#include "fusion.h"
+#include "native.h"
+#include "statement.h"
+
+#include <limits>
+#include <map>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace native {
+
+    namespace {
+
+        // ,    
+        struct Unsupported {};
+
+        //    ,        
+        // .        
+        constexpr string_view RESET_LOCALS = "\x01";
+
+        //  FNV-1a
+        uint64_t Fingerprint(string_view text) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (const char c : text) {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        bool IsIdentifier(const string& name) {
+            if (name.empty() || (name.front() >= '0' && name.front() <= '9')) return false;
+            for (const char c : name) {
+                if (!(c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        //    C++   value
+        string StringLiteral(string_view value) {
+            string result = "\"";
+            for (const char c : value) {
+                switch (c) {
+                case '"': result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\t': result += "\\t"; break;
+                case '\r': result += "\\r"; break;
+                default:
+                    if (c >= ' ' && c <= '~') {
+                        result += c;
+                    }
+                    else {
+                        //            
+                        const auto byte = static_cast<unsigned char>(c);
+                        result += '\\';
+                        result += static_cast<char>('0' + (byte >> 6));
+                        result += static_cast<char>('0' + ((byte >> 3) & 7));
+                        result += static_cast<char>('0' + (byte & 7));
+                    }
+                }
+            }
+            return result + '"';
+        }
+
+        void CollectClasses(runtime::Executable& node, vector<runtime::Class*>& classes) {
+            if (auto* definition = dynamic_cast<ast::ClassDefinition*>(&node)) {
+                classes.push_back(&definition->GetClass());
+            }
+            node.VisitChildren([&classes](unique_ptr<runtime::Executable>& child) {
+                CollectClasses(*child, classes);
+            });
+        }
+
+        //  : ,      .   
+        //    
+        class Constants {
+        public:
+            string Number(int64_t value) {
+                return Declare(numbers_, value, "n"sv, [value](const string& name) {
+                    const string literal = value == numeric_limits<int64_t>::min()
+                        ? "std::numeric_limits<std::int64_t>::min()"s : "std::int64_t{ "s + to_string(value) + " }"s;
+                    return "runtime::Number "s + name + "_value{ "s + literal + " };\n"s
+                        + "const runtime::ObjectHolder "s + name + " = runtime::ObjectHolder::Share("s + name + "_value);\n"s;
+                });
+            }
+
+            string String(const string& value) {
+                return Declare(strings_, value, "s"sv, [&value](const string& name) {
+                    return "runtime::String "s + name + "_value = runtime::String::Intern("s + StringLiteral(value) + ");\n"s
+                        + "const runtime::ObjectHolder "s + name + " = runtime::ObjectHolder::Share("s + name + "_value);\n"s;
+                });
+            }
+
+            string Name(const string& value) {
+                return Declare(names_, value, "k"sv, [&value](const string& name) {
+                    return "const std::string "s + name + " = "s + StringLiteral(value) + ";\n"s;
+                });
+            }
+
+            [[nodiscard]] const string& GetDeclarations() const noexcept {
+                return declarations_;
+            }
+
+        private:
+            template <typename Key, typename Declaration>
+            string Declare(map<Key, string>& names, const Key& key, string_view prefix, Declaration declaration) {
+                const auto it = names.find(key);
+                if (it != names.end()) return it->second;
+                string name = string(prefix) + to_string(names.size());
+                declarations_ += declaration(name);
+                names.emplace(key, name);
+                return name;
+            }
+
+            map<int64_t, string> numbers_;
+            map<string, string> strings_;
+            map<string, string> names_;
+            string declarations_;
+        };
+
+        /*
+         *       C++.      
+         *  ,       .
+         *  Mython,    ,   ,   
+         *     :   ,   
+         * ,   .   ,       
+         */
+        class MethodTranslator {
+        public:
+            MethodTranslator(const runtime::Method& method, const vector<runtime::Class*>& classes, Constants& constants)
+                : method_(method)
+                , classes_(classes)
+                , constants_(constants) {
+            }
+
+            //   .  Unsupported,    
+            string Translate() {
+                const auto* body = dynamic_cast<const ast::MethodBody*>(method_.body.get());
+                if (!body) throw Unsupported{};
+                for (const string& param : method_.formal_params) {
+                    //     self      
+                    if (!IsIdentifier(param) || param == runtime::SELF_NAME || !params_.insert(param).second) {
+                        throw Unsupported{};
+                    }
+                }
+
+                indent_ = 1;
+                Statement(body->GetBody());
+                Line("return {};"s);
+
+                ostringstream out;
+                out << "    native::Variable v_self(runtime::ObjectHolder::Borrow(self));\n"sv;
+                for (size_t i = 0; i < method_.formal_params.size(); ++i) {
+                    out << "    native::Variable v_"sv << method_.formal_params[i] << "(args["sv << i << "]);\n"sv;
+                }
+                for (const string& local : locals_) {
+                    out << "    native::Variable v_"sv << local << ";\n"sv;
+                }
+                if (tail_call_) {
+                    out << "entry:\n"sv;
+                }
+                out << "    runtime::StepBudget::Step();\n"sv;
+
+                istringstream lines(body_.str());
+                for (string line; getline(lines, line);) {
+                    if (const size_t marker = line.find(RESET_LOCALS); marker != string::npos) {
+                        for (const string& local : locals_) {
+                            out << line.substr(0, marker) << "v_"sv << local << ".Reset();\n"sv;
+                        }
+                        continue;
+                    }
+                    out << line << '\n';
+                }
+                return out.str();
+            }
+
+        private:
+            void Line(const string& text) {
+                body_ << string(indent_ * 4, ' ') << text << '\n';
+            }
+
+            void Open(const string& text) {
+                Line(text.empty() ? "{"s : text + " {"s);
+                ++indent_;
+            }
+
+            void Close() {
+                --indent_;
+                Line("}"s);
+            }
+
+            string NewName(char prefix) {
+                return prefix + to_string(next_name_++);
+            }
+
+            //    C++   Mython name
+            string Variable(const string& name) {
+                if (!IsIdentifier(name)) throw Unsupported{};
+                if (name != runtime::SELF_NAME && !params_.count(name)) {
+                    locals_.insert(name);
+                }
+                return "v_"s + name;
+            }
+
+            static string List(const vector<string>& values) {
+                string result = "{ "s;
+                for (const string& value : values) {
+                    if (&value != &values.front()) result += ", "s;
+                    result += value;
+                }
+                return values.empty() ? "{}"s : result + " }"s;
+            }
+
+            vector<string> Expressions(const vector<unique_ptr<ast::Statement>>& nodes) {
+                vector<string> values;
+                for (const auto& node : nodes) {
+                    values.push_back(Expression(*node));
+                }
+                return values;
+            }
+
+            //   .   C++   , 
+            //   
+            string Expression(const ast::Statement& node) {
+                if (const auto* constant = dynamic_cast<const ast::NumericConst*>(&node)) {
+                    return constants_.Number(constant->GetValue().GetValue());
+                }
+                if (const auto* constant = dynamic_cast<const ast::StringConst*>(&node)) {
+                    return constants_.String(string(constant->GetValue().GetView()));
+                }
+                if (const auto* constant = dynamic_cast<const ast::BoolConst*>(&node)) {
+                    return constant->GetValue().GetValue() ? "native::MakeBool(true)"s : "native::MakeBool(false)"s;
+                }
+                if (dynamic_cast<const ast::None*>(&node)) {
+                    return "runtime::ObjectHolder()"s;
+                }
+                if (const auto* variable = dynamic_cast<const ast::VariableValue*>(&node)) {
+                    return VariableValue(*variable);
+                }
+
+                const string name = NewName('t');
+                if (const auto* operation = dynamic_cast<const ast::BinaryOperation*>(&node)) {
+                    const char* function = dynamic_cast<const ast::Add*>(&node) ? "Add"
+                        : dynamic_cast<const ast::Sub*>(&node) ? "Sub"
+                        : dynamic_cast<const ast::Mult*>(&node) ? "Mult"
+                        : dynamic_cast<const ast::Div*>(&node) ? "Div" : nullptr;
+                    if (!function) return "native::MakeBool("s + Condition(node) + ")"s;
+                    const string lhs = Expression(operation->GetLhs());
+                    const string rhs = Expression(operation->GetRhs());
+                    Line("runtime::ObjectHolder "s + name + " = native::"s + function + "("s + lhs + ", "s + rhs + ", context);"s);
+                    return name;
+                }
+                if (dynamic_cast<const ast::Not*>(&node)) {
+                    return "native::MakeBool("s + Condition(node) + ")"s;
+                }
+                if (const auto* stringify = dynamic_cast<const ast::Stringify*>(&node)) {
+                    const string argument = Expression(stringify->GetArgument());
+                    Line("runtime::ObjectHolder "s + name + " = runtime::ToString("s + argument + ", context);"s);
+                    return name;
+                }
+                if (const auto* call = dynamic_cast<const ast::MethodCall*>(&node)) {
+                    const string object = Expression(call->GetObject());
+                    const string args = List(Expressions(call->GetArguments()));
+                    Line("runtime::ObjectHolder "s + name + " = native::Call("s + object + ", "s
+                        + constants_.Name(call->GetMethodName()) + ", "s + args + ", context);"s);
+                    return name;
+                }
+                if (const auto* instance = dynamic_cast<const ast::NewInstance*>(&node)) {
+                    const string cls = "*binding.classes["s + to_string(ClassIndex(instance->GetClass())) + "]"s;
+                    const string args = List(Expressions(instance->GetArguments()));
+                    Line("runtime::ObjectHolder "s + name + " = native::New("s + cls + ", "s + args + ", context);"s);
+                    return name;
+                }
+                throw Unsupported{};
+            }
+
+            string VariableValue(const ast::VariableValue& variable) {
+                const auto& ids = variable.GetDottedIds();
+                string value = Variable(ids.front()) + ".Get()"s;
+                const string name = NewName('t');
+                if (ids.size() == 1) {
+                    Line("const runtime::ObjectHolder& "s + name + " = "s + value + ";"s);
+                    return name;
+                }
+                for (size_t i = 1; i < ids.size(); ++i) {
+                    value = "native::Field("s + value + ", "s + constants_.Name(ids[i]) + ")"s;
+                }
+                Line("runtime::ObjectHolder "s + name + " = "s + value + ";"s);
+                return name;
+            }
+
+            //  .   C++  bool   
+            string Condition(const ast::Statement& node) {
+                if (const auto* comparison = dynamic_cast<const ast::Comparison*>(&node)) {
+                    const auto operation = ast::MatchComparator(comparison->GetComparator());
+                    if (!operation) throw Unsupported{};
+                    const string lhs = Expression(comparison->GetLhs());
+                    const string rhs = Expression(comparison->GetRhs());
+                    const string name = NewName('c');
+                    Line("const bool "s + name + " = native::"s + ComparatorName(*operation) + "("s + lhs + ", "s + rhs + ", context);"s);
+                    return name;
+                }
+                const auto* conjunction = dynamic_cast<const ast::And*>(&node);
+                if (const auto* operation = conjunction ? static_cast<const ast::BinaryOperation*>(conjunction)
+                                                        : dynamic_cast<const ast::Or*>(&node)) {
+                    //   ,      
+                    const string lhs = Condition(operation->GetLhs());
+                    const string name = NewName('c');
+                    Line("bool "s + name + " = "s + lhs + ";"s);
+                    Open((conjunction ? "if ("s : "if (!"s) + name + ")"s);
+                    const string rhs = Condition(operation->GetRhs());
+                    Line(name + " = "s + rhs + ";"s);
+                    Close();
+                    return name;
+                }
+                if (const auto* negation = dynamic_cast<const ast::Not*>(&node)) {
+                    return "!("s + Condition(negation->GetArgument()) + ")"s;
+                }
+                if (const auto* constant = dynamic_cast<const ast::BoolConst*>(&node)) {
+                    return constant->GetValue().GetValue() ? "true"s : "false"s;
+                }
+                return "runtime::IsTrue("s + Expression(node) + ")"s;
+            }
+
+            static const char* ComparatorName(ast::CompareWithConstant::Operation operation) {
+                using Operation = ast::CompareWithConstant::Operation;
+                switch (operation) {
+                case Operation::LESS: return "Less";
+                case Operation::GREATER: return "Greater";
+                case Operation::EQUAL: return "Equal";
+                case Operation::NOT_EQUAL: return "NotEqual";
+                case Operation::LESS_OR_EQUAL: return "LessOrEqual";
+                case Operation::GREATER_OR_EQUAL: return "GreaterOrEqual";
+                }
+                throw Unsupported{};
+            }
+
+            size_t ClassIndex(const runtime::Class& cls) const {
+                for (size_t i = 0; i < classes_.size(); ++i) {
+                    if (classes_[i] == &cls) return i;
+                }
+                throw Unsupported{};
+            }
+
+            void Statement(const ast::Statement& node) {
+                if (const auto* compound = dynamic_cast<const ast::Compound*>(&node)) {
+                    //    ,      
+                    for (const auto& statement : compound->GetStatements()) {
+                        Line("runtime::StepBudget::Step();"s);
+                        Open(""s);
+                        Statement(*statement);
+                        Close();
+                    }
+                }
+                else if (const auto* assignment = dynamic_cast<const ast::Assignment*>(&node)) {
+                    const string value = Expression(assignment->GetValue());
+                    Line(Variable(assignment->GetName()) + ".Set("s + value + ");"s);
+                }
+                else if (const auto* assignment = dynamic_cast<const ast::FieldAssignment*>(&node)) {
+                    const string object = VariableValue(assignment->GetObject());
+                    const string value = Expression(assignment->GetValue());
+                    Line("native::SetField("s + object + ", "s + constants_.Name(assignment->GetFieldName()) + ", "s + value + ");"s);
+                }
+                else if (const auto* print = dynamic_cast<const ast::Print*>(&node)) {
+                    const string out = NewName('o');
+                    Line("runtime::OutputSink& "s + out + " = context.GetOutput();"s);
+                    for (const auto& arg : print->GetArguments()) {
+                        if (arg != print->GetArguments().front()) Line(out + ".Write(\" \");"s);
+                        Line("runtime::WriteObject("s + Expression(*arg) + ", "s + out + ", context);"s);
+                    }
+                    Line(out + ".Write(\"\\n\");"s);
+                }
+                else if (const auto* ret = dynamic_cast<const ast::Return*>(&node)) {
+                    Line("return "s + Expression(ret->GetStatement()) + ";"s);
+                }
+                else if (const auto* tail_call = dynamic_cast<const ast::TailCall*>(&node)) {
+                    TailCall(tail_call->GetCall());
+                }
+                else if (const auto* loop = dynamic_cast<const ast::While*>(&node)) {
+                    Open("for (;;)"s);
+                    Line("if (!("s + Condition(loop->GetCondition()) + ")) break;"s);
+                    Line("runtime::StepBudget::Step();"s);
+                    ++loop_depth_;
+                    Statement(loop->GetBody());
+                    --loop_depth_;
+                    Close();
+                }
+                else if (const auto* loop = dynamic_cast<const ast::ForRange*>(&node)) {
+                    const string begin = NewName('b');
+                    Line("const std::int64_t "s + begin + " = native::RangeBound("s + Expression(loop->GetBegin()) + ");"s);
+                    const string end = NewName('e');
+                    Line("const std::int64_t "s + end + " = native::RangeBound("s + Expression(loop->GetEnd()) + ");"s);
+                    const string counter = NewName('i');
+                    Open("for (std::int64_t "s + counter + " = "s + begin + "; "s + counter + " < "s + end + "; ++"s + counter + ")"s);
+                    Line("runtime::StepBudget::Step();"s);
+                    Line(Variable(loop->GetVariable()) + ".SetNumber("s + counter + ");"s);
+                    ++loop_depth_;
+                    Statement(loop->GetBody());
+                    --loop_depth_;
+                    Close();
+                }
+                else if (const auto* branch = dynamic_cast<const ast::IfElse*>(&node)) {
+                    Open("if ("s + Condition(branch->GetCondition()) + ")"s);
+                    Statement(branch->GetIfBody());
+                    if (const ast::Statement* else_body = branch->GetElseBody()) {
+                        --indent_;
+                        Line("} else {"s);
+                        ++indent_;
+                        Statement(*else_body);
+                    }
+                    Close();
+                }
+                else if (dynamic_cast<const ast::Break*>(&node) || dynamic_cast<const ast::Continue*>(&node)) {
+                    //    break  continue     None
+                    const bool is_break = dynamic_cast<const ast::Break*>(&node) != nullptr;
+                    Line(loop_depth_ == 0 ? "return {};"s : is_break ? "break;"s : "continue;"s);
+                }
+                else if (dynamic_cast<const ast::ClassDefinition*>(&node)) {
+                    throw Unsupported{};
+                }
+                else {
+                    const string value = Expression(node);
+                    if (node.IsPure()) Line("static_cast<void>("s + value + ");"s);
+                }
+            }
+
+            // return self.method(args):         
+            //    ,    ,   
+            void TailCall(const ast::MethodCall& call) {
+                //    ,     
+                const string object = Expression(call.GetObject());
+                const vector<string> args = Expressions(call.GetArguments());
+                const string method = NewName('m');
+                Line("const runtime::Method& "s + method + " = native::FindTailCallMethod("s + object + ", "s
+                    + constants_.Name(call.GetMethodName()) + ", "s + to_string(call.GetArgumentCount()) + ");"s);
+                if (args.size() != method_.formal_params.size()) {
+                    Line("return native::Invoke("s + object + ", "s + method + ", "s + List(args) + ", context);"s);
+                    return;
+                }
+
+                Open("if (&"s + method + " == binding.method)"s);
+                //     ,    
+                vector<string> copies;
+                for (const string& arg : args) {
+                    copies.push_back(NewName('u'));
+                    Line("runtime::ObjectHolder "s + copies.back() + " = "s + arg + ";"s);
+                }
+                for (size_t i = 0; i < copies.size(); ++i) {
+                    Line("v_"s + method_.formal_params[i] + ".Set(std::move("s + copies[i] + "));"s);
+                }
+                Line(string(RESET_LOCALS));
+                Line("goto entry;"s);
+                Close();
+                Line("return native::Invoke("s + object + ", "s + method + ", "s + List(args) + ", context);"s);
+                tail_call_ = true;
+            }
+
+            const runtime::Method& method_;
+            const vector<runtime::Class*>& classes_;
+            Constants& constants_;
+
+            set<string> params_;
+            set<string> locals_;
+            ostringstream body_;
+            size_t indent_ = 0;
+            size_t next_name_ = 0;
+            size_t loop_depth_ = 0;
+            bool tail_call_ = false;
+        };
+
+        //      Module,     
+        string TranslateProgram(runtime::Executable& root) {
+            vector<runtime::Class*> classes;
+            CollectClasses(root, classes);
+
+            Constants constants;
+            ostringstream functions;
+            ostringstream methods;
+            size_t method_count = 0;
+            for (size_t class_index = 0; class_index < classes.size(); ++class_index) {
+                const runtime::Class& cls = *classes[class_index];
+                for (size_t method_index = 0; method_index < cls.methods_.size(); ++method_index) {
+                    const runtime::Method& method = cls.methods_[method_index];
+                    //  ,    ,    
+                    Constants method_constants = constants;
+                    string body;
+                    try {
+                        body = MethodTranslator(method, classes, method_constants).Translate();
+                    }
+                    catch (const Unsupported&) {
+                        continue;
+                    }
+                    constants = std::move(method_constants);
+
+                    const string name = "method_"s + to_string(method_count++);
+                    functions << "\n// "sv << cls.GetName() << '.' << method.name << '(';
+                    for (const string& param : method.formal_params) {
+                        functions << (&param == &method.formal_params.front() ? ""sv : ", "sv) << param;
+                    }
+                    functions << ")\n"sv
+                        << "runtime::ObjectHolder "sv << name << "([[maybe_unused]] runtime::ClassInstance& self,\n"sv
+                        << "    [[maybe_unused]] std::span<const runtime::ObjectHolder> args,\n"sv
+                        << "    [[maybe_unused]] runtime::Context& context,\n"sv
+                        << "    [[maybe_unused]] const native::Binding& binding) {\n"sv
+                        << body << "}\n"sv;
+                    methods << "    { "sv << class_index << ", "sv << method_index << ", "sv << StringLiteral(method.name)
+                        << ", "sv << name << " },\n"sv;
+                }
+            }
+
+            ostringstream out;
+            out << "// Generated by mython --emit-cpp. The module can only be loaded into the program it was\n"sv
+                << "// generated from. Build it with the headers of the same interpreter:\n"sv
+                << "//   c++ -std=c++20 -O2 -shared -fPIC -I<mython sources> <this file> -o <module>.so\n\n"sv
+                << "#include \"native.h\"\n\n"sv
+                << "#include <cstdint>\n#include <limits>\n#include <span>\n#include <string>\n#include <utility>\n\n"sv
+                << "namespace {\n\n"sv
+                << constants.GetDeclarations()
+                << functions.str() << '\n';
+            if (method_count == 0) {
+                out << "const native::ModuleMethod* const METHODS = nullptr;\n\n"sv;
+            }
+            else {
+                out << "const native::ModuleMethod METHODS[] = {\n"sv << methods.str() << "};\n\n"sv;
+            }
+            out << "constexpr std::size_t CLASS_COUNT = "sv << classes.size() << ";\n"sv
+                << "constexpr std::size_t METHOD_COUNT = "sv << method_count << ";\n\n"sv
+                << "}  // namespace\n"sv;
+            return out.str();
+        }
+
+    }  // namespace
+
+    void EmitModule(runtime::Executable& root, ostream& out) {
+        const string text = TranslateProgram(root);
+        out << text << '\n'
+            << "extern \"C\" const native::Module "sv << MODULE_SYMBOL << "{ native::ABI_VERSION, "sv
+            << Fingerprint(text) << "ULL, CLASS_COUNT, METHODS, METHOD_COUNT };\n"sv;
+    }
+
+    uint64_t ModuleFingerprint(runtime::Executable& root) {
+        return Fingerprint(TranslateProgram(root));
+    }
+
+    vector<runtime::Class*> ProgramClasses(runtime::Executable& root) {
+        vector<runtime::Class*> classes;
+        CollectClasses(root, classes);
+        return classes;
+    }
+
+}  // namespace native
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "runtime.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace native {
+
+    /*
+     *     root   C++ (. native.h).   
+     * ,    -  C++,     
+     *     ,    .      
+     *  runtime::  ast::,    ,      ,  .
+     *   ,    ,   .
+     *
+     *       ,     ,   
+     *  .    
+     *   c++ -std=c++20 -O2 -shared -fPIC -I< mython> module.cpp -o module.so
+     *    LoadModule ,   -rdynamic
+     */
+    void EmitModule(runtime::Executable& root, std::ostream& out);
+
+    //   ,  EmitModule    root.  
+    // ,     
+    [[nodiscard]] std::uint64_t ModuleFingerprint(runtime::Executable& root);
+
+    //      .      
+    [[nodiscard]] std::vector<runtime::Class*> ProgramClasses(runtime::Executable& root);
+
+}  // namespace native